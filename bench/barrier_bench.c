@@ -0,0 +1,151 @@
+/**
+ * @file    barrier_bench.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details Microbenchmark comparing the cost of crossing a pthread barrier
+ *          against the spinning barrier, for 2 to 256 participants.
+ *          Every round each thread crosses two barriers back to back, the
+ *          same way the main thread and the airport workers do every tick.
+ *
+ *          usage: barrier_bench [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "barrier.h"
+
+#define DEFAULT_ROUNDS      2000u
+#define MAX_PARTICIPANTS    256u
+
+typedef enum {
+    PTHREAD_BARRIER,
+    SPIN_BARRIER,
+    BARRIER_TYPES
+} barrier_types_t;
+
+static const char *barrier_names[BARRIER_TYPES] = {"pthread", "spin"};
+
+typedef struct {
+    barrier_types_t     type;
+    uint32_t            rounds;
+    pthread_barrier_t   pthread_sync[2];
+    spin_barrier_t      spin_sync[2];
+} bench_param_t;
+
+/**
+ * @brief   Crosses one of the benchmark's barriers.
+ * @param   [in, out] bench: bench_param_t*
+ *                           -- Pointer to the benchmark parameters.
+ * @param   [in] which: int
+ *                      -- Which of the two barriers to cross.
+ */
+static void cross(bench_param_t *bench, int which)
+{
+    if (bench->type == PTHREAD_BARRIER) {
+        pthread_barrier_wait(&bench->pthread_sync[which]);
+    }
+    else {
+        spin_barrier_wait(&bench->spin_sync[which]);
+    }
+}
+
+/**
+ * @brief   Benchmark thread function.
+ * @param   [in, out] arg: [void *]
+ *          -- Pointer to the benchmark parameters.
+ * @return  [void *]
+ *          -- Will always return NULL.
+ */
+static void* bench_thread(void *arg)
+{
+    bench_param_t *bench = arg;
+
+    for (uint32_t i = 0; i < bench->rounds; i++) {
+        cross(bench, 0);
+        cross(bench, 1);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief   Times a number of barrier rounds for a set amount of threads.
+ * @param   [in, out] bench: bench_param_t*
+ *                           -- Pointer to the benchmark parameters.
+ * @param   [in] participants: uint32_t
+ *                             -- Number of threads crossing the barriers,
+ *                                including the calling thread.
+ * @return  double
+ *          -- Average time in nanoseconds for a single barrier crossing.
+ */
+static double run(bench_param_t *bench, uint32_t participants)
+{
+    pthread_t threads[MAX_PARTICIPANTS];
+    struct timespec start, end;
+
+    for (int i = 0; i < 2; i++) {
+        pthread_barrier_init(&bench->pthread_sync[i], NULL, participants);
+        spin_barrier_init(&bench->spin_sync[i], participants);
+    }
+
+    for (uint32_t i = 1; i < participants; i++) {
+        pthread_create(&threads[i], NULL, bench_thread, bench);
+    }
+
+    // Warm up so thread creation isn't part of the measurement.
+    cross(bench, 0);
+    cross(bench, 1);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 1; i < bench->rounds; i++) {
+        cross(bench, 0);
+        cross(bench, 1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (uint32_t i = 1; i < participants; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        pthread_barrier_destroy(&bench->pthread_sync[i]);
+        spin_barrier_destroy(&bench->spin_sync[i]);
+    }
+
+    double elapsed = (end.tv_sec - start.tv_sec) * 1e9 +
+                     (end.tv_nsec - start.tv_nsec);
+    return elapsed / (2.0 * (bench->rounds - 1));
+}
+
+int main(int argc, char **argv)
+{
+    bench_param_t bench;
+    bench.rounds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) :
+                   DEFAULT_ROUNDS;
+
+    if (bench.rounds < 2) {
+        bench.rounds = 2;
+    }
+
+    printf("participants,%s_ns,%s_ns\n",
+           barrier_names[PTHREAD_BARRIER], barrier_names[SPIN_BARRIER]);
+
+    for (uint32_t n = 2; n <= MAX_PARTICIPANTS; n *= 2) {
+        double result[BARRIER_TYPES];
+
+        for (int type = 0; type < BARRIER_TYPES; type++) {
+            bench.type = type;
+            result[type] = run(&bench, n);
+        }
+
+        printf("%u,%.1f,%.1f\n", n, result[PTHREAD_BARRIER],
+               result[SPIN_BARRIER]);
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,353 @@
+/**
+ * @file    contention_bench.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details Benchmark of the contention between threads handing flights to
+ *          each other, comparing the two layouts the simulation keeps its
+ *          flight queues in: packed into the airports, which only their own
+ *          worker queues at, and the mailboxes of the workers, which every
+ *          other worker queues at, with the head and the tail on cache lines
+ *          of their own.
+ *          Every tick the threads first queue flights, then cross a barrier
+ *          and serve them, with airports and workers handed out round robin
+ *          so neighbours are always served by different threads, and queued
+ *          at by a thread other than the one serving them.
+ *          Cache misses are counted with the processor's performance
+ *          counters, where the system lets them be read. Misses on lines
+ *          another core has written to are what the mailboxes save, which
+ *          only shows with several processors.
+ *
+ *          usage: contention_bench [threads] [ticks] [airports]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "atsim_definitions.h"
+
+#define DEFAULT_THREADS     4u
+#define DEFAULT_TICKS       20000u
+#define DEFAULT_AIRPORTS    64u
+#define FLIGHTS_PER_TICK    4u
+#define MAX_THREADS         256u
+
+typedef enum {
+    PACKED_LAYOUT,
+    MAILBOX_LAYOUT,
+    LAYOUTS
+} layouts_t;
+
+static const char *layout_names[LAYOUTS] = {"packed", "mailbox"};
+
+typedef enum {
+    L1D_MISSES,
+    LLC_MISSES,
+    COUNTERS
+} counters_t;
+
+typedef struct {
+    layouts_t           layout;
+    uint32_t            threads;
+    uint32_t            ticks;
+    uint32_t            airports;
+    airport_t*          packed;
+    worker_t*           workers;    // One in place of each airport
+    spin_barrier_t      sync;
+} bench_param_t;
+
+typedef struct {
+    bench_param_t*  bench;
+    uint32_t        thread;
+    pthread_t       handle;
+} bench_thread_t;
+
+/**
+ * @brief   Has a thread queue its flights for this tick.
+ * @param   [in, out] bench: bench_param_t*
+ *                           -- Pointer to the benchmark parameters.
+ * @param   [in] thread: uint32_t
+ *                       -- Index of the thread, which queues at the airports
+ *                          or workers the next thread serves.
+ */
+static void produce(bench_param_t *bench, uint32_t thread)
+{
+    uint32_t first = (thread + 1) % bench->threads;
+
+    for (uint32_t i = first; i < bench->airports; i += bench->threads) {
+        for (uint32_t j = 0; j < FLIGHTS_PER_TICK; j++) {
+            if (bench->layout == PACKED_LAYOUT) {
+                enqueue(&bench->packed[i].departures_queue, j);
+                enqueue(&bench->packed[i].arrivals_queue, j);
+            }
+            else {
+                mailbox_enqueue(&bench->workers[i].inbox, j);
+                mailbox_enqueue(&bench->workers[i].takeoffs, j);
+            }
+        }
+    }
+}
+
+/**
+ * @brief   Has a thread serve its airports or workers for this tick.
+ * @param   [in, out] bench: bench_param_t*
+ *                           -- Pointer to the benchmark parameters.
+ * @param   [in] thread: uint32_t
+ *                       -- Index of the thread.
+ * @details Every flight queued this tick is served, looking at the size of
+ *          both queues each time, as the simulation does when it records
+ *          runway metrics. Airports write down their runway's state, and
+ *          workers the ticks they worked, next to their queues.
+ * @return  uint32_t
+ *          -- Sum of the queue sizes seen, so none of the work is left out.
+ */
+static uint32_t serve(bench_param_t *bench, uint32_t thread)
+{
+    uint32_t seen = 0;
+
+    for (uint32_t i = thread; i < bench->airports; i += bench->threads) {
+        for (uint32_t j = 0; j < 2 * FLIGHTS_PER_TICK; j++) {
+            queue_types_t type = (queue_types_t)(j & 1u);
+
+            if (bench->layout == PACKED_LAYOUT) {
+                airport_t *airport = &bench->packed[i];
+                flight_queue_t *queue = (type == DEPARTURE) ?
+                        &airport->departures_queue : &airport->arrivals_queue;
+
+                airport->runway_flight = try_pop(queue);
+                airport->last_queue_type = type;
+                seen += size(&airport->departures_queue) +
+                        size(&airport->arrivals_queue);
+            }
+            else {
+                worker_t *worker = &bench->workers[i];
+                flight_mailbox_t *mailbox = (type == DEPARTURE) ?
+                        &worker->inbox : &worker->takeoffs;
+
+                worker->next_clock = mailbox_try_pop(mailbox);
+                worker->worked |= (uint64_t)1 << j;
+                seen += mailbox_size(&worker->inbox) +
+                        mailbox_size(&worker->takeoffs);
+            }
+        }
+    }
+
+    return seen;
+}
+
+/**
+ * @brief   Benchmark thread function.
+ * @param   [in] arg: [void *]
+ *          -- Pointer to the thread's benchmark data.
+ * @return  [void *]
+ *          -- Will always return NULL.
+ */
+static void* bench_thread(void *arg)
+{
+    bench_thread_t *self = arg;
+    bench_param_t *bench = self->bench;
+    volatile uint32_t seen = 0;
+
+    for (uint32_t i = 0; i < bench->ticks; i++) {
+        produce(bench, self->thread);
+        spin_barrier_wait(&bench->sync);
+        seen += serve(bench, self->thread);
+        spin_barrier_wait(&bench->sync);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief   Opens one of the performance counters for this process and the
+ *          threads it starts from now on.
+ * @param   [in] counter: counters_t
+ *                        -- Counter to open.
+ * @return  int
+ *          -- File descriptor of the counter, or -1 if it can't be read.
+ */
+static int open_counter(counters_t counter)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    if (counter == L1D_MISSES) {
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D |
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+    else {
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    }
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * @brief   Runs the benchmark for one of the layouts.
+ * @param   [in, out] bench: bench_param_t*
+ *                           -- Pointer to the benchmark parameters, with
+ *                              its airports initialized.
+ * @param   [out] misses: double*
+ *                        -- Misses per tick of each counter, or -1 for the
+ *                           ones that couldn't be read.
+ * @return  double
+ *          -- Seconds the run took.
+ */
+static double run_layout(bench_param_t *bench, double *misses)
+{
+    bench_thread_t threads[MAX_THREADS];
+    int counters[COUNTERS];
+    struct timespec start, end;
+
+    for (int i = 0; i < COUNTERS; i++) {
+        if ((counters[i] = open_counter((counters_t)i)) >= 0) {
+            ioctl(counters[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    spin_barrier_init(&bench->sync, bench->threads);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (uint32_t i = 0; i < bench->threads; i++) {
+        threads[i].bench = bench;
+        threads[i].thread = i;
+        pthread_create(&threads[i].handle, NULL, bench_thread, &threads[i]);
+    }
+
+    for (uint32_t i = 0; i < bench->threads; i++) {
+        pthread_join(threads[i].handle, NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    spin_barrier_destroy(&bench->sync);
+
+    // The threads are done, so their counts have been added to this one's.
+    for (int i = 0; i < COUNTERS; i++) {
+        uint64_t count;
+
+        misses[i] = -1.0;
+
+        if (counters[i] >= 0) {
+            ioctl(counters[i], PERF_EVENT_IOC_DISABLE, 0);
+
+            if (read(counters[i], &count, sizeof(count)) == sizeof(count)) {
+                misses[i] = (double)count / bench->ticks;
+            }
+
+            close(counters[i]);
+        }
+    }
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief   Sets up the airports and workers of both layouts.
+ * @param   [in, out] bench: bench_param_t*
+ *                           -- Pointer to the benchmark parameters.
+ * @details The airports are packed one after the other in a single block,
+ *          the way the airport store keeps them, and the workers are kept
+ *          in an array the way the simulation keeps them.
+ * @return  bool
+ *          -- True if everything was set up, False if memory ran out.
+ */
+static bool init_airports(bench_param_t *bench)
+{
+    uint32_t slots = 2 * FLIGHTS_PER_TICK;
+
+    bench->packed = calloc(bench->airports, sizeof(airport_t));
+    bench->workers = aligned_alloc(WORKER_CACHE_LINE,
+                                   bench->airports * sizeof(worker_t));
+
+    if (bench->packed == NULL || bench->workers == NULL) {
+        return false;
+    }
+
+    memset(bench->workers, 0, bench->airports * sizeof(worker_t));
+
+    for (uint32_t i = 0; i < bench->airports; i++) {
+        if (init_queue(&bench->packed[i].departures_queue, slots) != 0 ||
+            init_queue(&bench->packed[i].arrivals_queue, slots) != 0 ||
+            init_mailbox(&bench->workers[i].inbox, slots) != 0 ||
+            init_mailbox(&bench->workers[i].takeoffs, slots) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bench_param_t bench = {
+            .threads  = (argc > 1) ? strtoul(argv[1], NULL, 10) :
+                        DEFAULT_THREADS,
+            .ticks    = (argc > 2) ? strtoul(argv[2], NULL, 10) :
+                        DEFAULT_TICKS,
+            .airports = (argc > 3) ? strtoul(argv[3], NULL, 10) :
+                        DEFAULT_AIRPORTS
+    };
+    double seconds[LAYOUTS];
+    double misses[LAYOUTS][COUNTERS];
+
+    if (bench.threads < 2 || bench.threads > MAX_THREADS || bench.ticks < 1 ||
+        bench.airports < bench.threads) {
+        fprintf(stderr, "usage: %s [threads] [ticks] [airports]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!init_airports(&bench)) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < LAYOUTS; i++) {
+        bench.layout = (layouts_t)i;
+        seconds[i] = run_layout(&bench, misses[i]);
+    }
+
+    printf("%u threads, %u airports, %u ticks, %ld processors\n",
+           bench.threads, bench.airports, bench.ticks,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-10s %12s %16s %16s\n", "layout", "ns/tick", "L1D misses/tick",
+           "LLC misses/tick");
+
+    for (int i = 0; i < LAYOUTS; i++) {
+        printf("%-10s %12.1f", layout_names[i], seconds[i] * 1e9 / bench.ticks);
+
+        for (int j = 0; j < COUNTERS; j++) {
+            if (misses[i][j] < 0) {
+                printf(" %16s", "n/a");
+            }
+            else {
+                printf(" %16.1f", misses[i][j]);
+            }
+        }
+
+        putchar('\n');
+    }
+
+    if (misses[0][0] < 0 && misses[0][1] < 0) {
+        fflush(stdout);
+        fprintf(stderr, "%s: performance counters can't be read here, see "
+                        "/proc/sys/kernel/perf_event_paranoid\n", argv[0]);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file    parse_bench.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details Benchmark of the schedule parsing throughput.
+ *          Flights are spread over a set number of airports (10000 by
+ *          default), so the cost of interning the airport codes shows up
+ *          next to the cost of parsing each line. The schedule is written to
+ *          a temporary file first, and read back the same way atsim reads
+ *          its input.
+ *
+ *          usage: parse_bench [flights] [airports]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "schedule.h"
+
+#define DEFAULT_FLIGHTS     1000000u
+#define DEFAULT_AIRPORTS    10000u
+
+static simulation_param_t sim;
+
+/**
+ * @brief   Writes the airport code of a given airport number.
+ * @param   [out] code: char*
+ *                      -- Buffer of at least CODE_STR_SIZE characters.
+ * @param   [in] airport: uint32_t
+ *                        -- Airport number, below 26^3.
+ */
+static void airport_code(char *code, uint32_t airport)
+{
+    for (int i = CODE_LENGTH - 1; i >= 0; i--) {
+        code[i] = (char)('A' + airport % AIRPORT_CODE_LETTERS);
+        airport /= AIRPORT_CODE_LETTERS;
+    }
+
+    code[CODE_LENGTH] = '\0';
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t flights = (argc > 1) ? strtoul(argv[1], NULL, 10) :
+                       DEFAULT_FLIGHTS;
+    uint32_t airports = (argc > 2) ? strtoul(argv[2], NULL, 10) :
+                        DEFAULT_AIRPORTS;
+
+    if (airports < 1 || airports > AIRPORT_DIRECT_SIZE) {
+        fprintf(stderr, "airports must be between 1 and %u\n",
+                AIRPORT_DIRECT_SIZE);
+        return EXIT_FAILURE;
+    }
+
+    FILE *schedule = tmpfile();
+    long bytes;
+    srand(1);
+
+    if (schedule == NULL) {
+        perror("parse_bench: tmpfile");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t i = 0; i < flights; i++) {
+        char origin[CODE_STR_SIZE], destination[CODE_STR_SIZE];
+
+        airport_code(origin, rand() % airports);
+        airport_code(destination, rand() % airports);
+        fprintf(schedule, "AC %d %d %s %d:%02d %d %s\n", rand() % 10000,
+                rand() % 50000, origin, rand() % 24, rand() % 60,
+                30 + rand() % 300, destination);
+    }
+
+    fprintf(schedule, "end\n");
+    fflush(schedule);
+    bytes = ftell(schedule);
+    rewind(schedule);
+
+    if (!init_stores(&sim, flights, airports, 50000)) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (!read_schedule(&sim, fileno(schedule))) {
+        perror("parse_bench: read_schedule");
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) +
+                     (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("flights,airports,seconds,flights_per_s,mb_per_s\n");
+    printf("%u,%u,%.3f,%.0f,%.1f\n", sim.flight_count, sim.airports.count,
+           seconds, sim.flight_count / seconds, bytes / seconds / 1e6);
+
+    deinit_stores(&sim);
+    fclose(schedule);
+    return 0;
+}
@@ -0,0 +1,490 @@
+/**
+ * @file    sim_bench.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details Benchmark of the whole simulation over synthetic schedules.
+ *          Each plane flies a chain of legs, every leg departing from where
+ *          the last one landed, so flights don't end up waiting on planes
+ *          that never come. A share of the legs start or end at a handful of
+ *          hub airports, which concentrates the traffic on their runways.
+ *          Schedules are generated from a seed, so every configuration
+ *          is the same from one run to the next.
+ *
+ *          Every configuration runs in a process of its own, so its peak
+ *          resident set size is its own too. The results are written as CSV
+ *          to the output file, one line per configuration.
+ *
+ *          usage: sim_bench [-j threads] [--flights N] [--airports N]
+ *                           [--planes N] [--hubs N] [--hub-share PERCENT]
+ *                           [--days N] [--seed S] [--max-flights N]
+ *                           [--output FILE] [--generate]
+ *
+ *          Without any of --flights, --airports, --planes, --hubs or
+ *          --hub-share, a sweep of configurations is run, skipping those
+ *          over --max-flights (1000000 by default, up to 10000000). The
+ *          configuration given is filled in from the 100000 flight one.
+ *          Simulated minutes per second only count the simulation, not the
+ *          parsing.
+ *          With --generate the schedule of the configuration is written to
+ *          standard output instead, ready to be fed to atsim.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "schedule.h"
+#include "simulation.h"
+
+#define DEFAULT_OUTPUT      "sim_bench.csv"
+#define DEFAULT_MAX_FLIGHTS 1000000u
+#define DEFAULT_SEED        1u
+
+// Legs last from 30 minutes up to 5 hours, when the day leaves room for it.
+#define LEG_MIN_DURATION    30u
+#define LEG_MAX_DURATION    300u
+
+// Time a leg takes on top of its flight, on the ground at both ends.
+#define LEG_GROUND_TIME     (2*TAXI_DURATION + PLANE_GROOM_DURATION)
+
+typedef struct {
+    uint32_t    flights;
+    uint32_t    airports;
+    uint32_t    planes;
+    uint32_t    hubs;
+    uint32_t    hub_share;  // Percent of leg ends at a hub
+    uint32_t    days;
+} bench_config_t;
+
+/*
+ * Sweep run when no configuration is given: flights from 1k to 10M at a
+ * fixed shape, then the shape varied around 100k flights.
+ */
+static const bench_config_t sweep[] = {
+        {1000u,     100u,   250u,     5u,   50u, 1u},
+        {10000u,    1000u,  2500u,    10u,  50u, 1u},
+        {100000u,   5000u,  25000u,   50u,  50u, 1u},
+        {1000000u,  17576u, 250000u,  100u, 50u, 1u},
+        {10000000u, 17576u, 2500000u, 100u, 50u, 1u},
+        {100000u,   100u,   25000u,   50u,  50u, 1u},
+        {100000u,   17576u, 25000u,   50u,  50u, 1u},
+        {100000u,   5000u,  5000u,    50u,  50u, 1u},
+        {100000u,   5000u,  100000u,  50u,  50u, 1u},
+        {100000u,   5000u,  25000u,   50u,  0u,  1u},
+        {100000u,   5000u,  25000u,   5u,   90u, 1u},
+        {100000u,   5000u,  25000u,   50u,  50u, 7u},
+};
+
+/**
+ * @brief   Draws the next number of a splitmix64 random stream.
+ * @param   [in, out] state: uint64_t*
+ *                           -- State of the stream.
+ * @return  uint64_t
+ *          -- Uniformly distributed random number.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t value = (*state += 0x9E3779B97F4A7C15ull);
+
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief   Draws a random number below a bound.
+ * @param   [in, out] state: uint64_t*
+ *                           -- State of the random stream drawn from.
+ * @param   [in] bound: uint32_t
+ *                      -- Bound of the number, above zero.
+ * @return  uint32_t
+ *          -- Random number from 0 up to bound - 1.
+ */
+static uint32_t random_below(uint64_t *state, uint32_t bound)
+{
+    return (uint32_t)(((next_random(state) >> 32) * bound) >> 32);
+}
+
+/**
+ * @brief   Picks an airport at one end of a leg.
+ * @param   [in] config: const bench_config_t*
+ *                       -- Configuration being generated.
+ * @param   [in, out] state: uint64_t*
+ *                           -- State of the random stream drawn from.
+ * @details The hubs are the first airports.
+ * @return  uint32_t
+ *          -- Airport number.
+ */
+static uint32_t pick_airport(const bench_config_t *config, uint64_t *state)
+{
+    if (random_below(state, 100) < config->hub_share) {
+        return random_below(state, config->hubs);
+    }
+
+    return random_below(state, config->airports);
+}
+
+/**
+ * @brief   Writes the airport code of a given airport number.
+ * @param   [out] code: char*
+ *                      -- Buffer of at least CODE_STR_SIZE characters.
+ * @param   [in] airport: uint32_t
+ *                        -- Airport number, below 26^3.
+ */
+static void airport_code(char *code, uint32_t airport)
+{
+    for (int i = CODE_LENGTH - 1; i >= 0; i--) {
+        code[i] = (char)('A' + airport % AIRPORT_CODE_LETTERS);
+        airport /= AIRPORT_CODE_LETTERS;
+    }
+
+    code[CODE_LENGTH] = '\0';
+}
+
+/**
+ * @brief   Generates the schedule of a configuration.
+ * @param   [out] schedule: FILE*
+ *                          -- File the schedule is written to.
+ * @param   [in] config: const bench_config_t*
+ *                       -- Configuration to generate.
+ * @param   [in] seed: uint64_t
+ *                     -- Seed of the schedule.
+ * @details The flights are split evenly between the planes, and each plane
+ *          spreads its legs over the simulated days, leaving room for the
+ *          taxis and the grooming between them.
+ */
+static void generate_schedule(FILE *schedule, const bench_config_t *config,
+                              uint64_t seed)
+{
+    uint64_t state = seed;
+    uint32_t minutes = config->days * MINUTES_PER_DAY;
+    uint32_t flight = 0;
+
+    for (uint32_t plane = 0; plane < config->planes; plane++) {
+        uint32_t legs = config->flights / config->planes +
+                        (plane < config->flights % config->planes);
+        uint32_t budget = (legs > 0) ? minutes / legs : minutes;
+        uint32_t longest = (budget > LEG_GROUND_TIME + LEG_MIN_DURATION) ?
+                budget - LEG_GROUND_TIME : LEG_MIN_DURATION;
+        uint32_t airport = pick_airport(config, &state);
+        uint32_t clock = random_below(&state, budget / 2 + 1);
+
+        longest = (longest > LEG_MAX_DURATION) ? LEG_MAX_DURATION : longest;
+
+        for (uint32_t leg = 0; leg < legs; leg++, flight++) {
+            uint32_t destination = pick_airport(config, &state);
+            uint32_t duration = LEG_MIN_DURATION +
+                    random_below(&state, longest - LEG_MIN_DURATION + 1);
+            uint32_t spare = (budget > duration + LEG_GROUND_TIME) ?
+                    budget - duration - LEG_GROUND_TIME : 0;
+            char origin_code[CODE_STR_SIZE], destination_code[CODE_STR_SIZE];
+
+            if (destination == airport) {
+                destination = (destination + 1) % config->airports;
+            }
+
+            airport_code(origin_code, airport);
+            airport_code(destination_code, destination);
+            fprintf(schedule, "%c%c %u %u %s %u:%02u:%02u %u %s\n",
+                    'A' + flight % 26, 'A' + flight / 26 % 26,
+                    flight / 676 % 10000, plane, origin_code,
+                    clock / MINUTES_PER_DAY, clock / 60 % 24, clock % 60,
+                    duration, destination_code);
+
+            airport = destination;
+            clock += duration + LEG_GROUND_TIME +
+                     random_below(&state, spare / 4 + 1);
+        }
+    }
+
+    fprintf(schedule, "end\n");
+}
+
+/**
+ * @brief   Finds the seconds between two points in time.
+ * @param   [in] start: const struct timespec*
+ *                      -- Earlier point in time.
+ * @param   [in] end: const struct timespec*
+ *                    -- Later point in time.
+ * @return  double
+ *          -- Seconds from start to end.
+ */
+static double seconds_between(const struct timespec *start,
+                              const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) +
+           (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief   Runs a configuration, in the process it's called from.
+ * @param   [in] config: const bench_config_t*
+ *                       -- Configuration to run.
+ * @param   [in] seed: uint64_t
+ *                     -- Seed of the schedule.
+ * @param   [in] threads: uint16_t
+ *                        -- Number of airport workers.
+ * @param   [in] report: int
+ *                       -- File descriptor the timings are written to, as
+ *                          the parse and simulation seconds.
+ * @details The results go to /dev/null, so the cost of formatting them is
+ *          measured but not the cost of storing them.
+ * @return  bool
+ *          -- True if the configuration ran, False if it failed.
+ */
+static bool run_config(const bench_config_t *config, uint64_t seed,
+                       uint16_t threads, int report)
+{
+    static simulation_param_t sim;
+    FILE *schedule = tmpfile();
+    int null = open("/dev/null", O_WRONLY);
+    struct timespec start, parsed, end;
+
+    if (schedule == NULL || null < 0) {
+        perror("sim_bench");
+        return false;
+    }
+
+    generate_schedule(schedule, config, seed);
+    fflush(schedule);
+    rewind(schedule);
+
+    sim.horizon       = config->days * MINUTES_PER_DAY;
+    sim.worker_count  = threads;
+    sim.checkpoint_at = NO_EVENT;
+
+    if (!init_stores(&sim, config->flights, config->airports,
+                     config->planes) ||
+        !init_output(&sim.output, null, OUTPUT_BUFFER_SIZE,
+                     sim.horizon > MINUTES_PER_DAY)) {
+        fprintf(stderr, "sim_bench: out of memory\n");
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (!load_schedule(&sim, fileno(schedule)) || !sort_flights(&sim)) {
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &parsed);
+
+    if (!run_simulation(&sim, -1)) {
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double timings[2] = {
+            seconds_between(&start, &parsed), seconds_between(&parsed, &end)
+    };
+
+    deinit_output(&sim.output);
+    deinit_stores(&sim);
+    fclose(schedule);
+    close(null);
+
+    return write(report, timings, sizeof(timings)) == sizeof(timings);
+}
+
+/**
+ * @brief   Runs a configuration in a child process and writes out its line
+ *          of results.
+ * @param   [out] results: FILE*
+ *                         -- File the line of results is written to.
+ * @param   [in] config: const bench_config_t*
+ *                       -- Configuration to run.
+ * @param   [in] seed: uint64_t
+ *                     -- Seed of the schedule.
+ * @param   [in] threads: uint16_t
+ *                        -- Number of airport workers.
+ * @return  bool
+ *          -- True if the configuration ran, False if it failed.
+ */
+static bool bench_config(FILE *results, const bench_config_t *config,
+                         uint64_t seed, uint16_t threads)
+{
+    double timings[2];
+    struct rusage usage;
+    int status, report[2];
+    pid_t child;
+
+    if (pipe(report) != 0 || (child = fork()) < 0) {
+        perror("sim_bench");
+        return false;
+    }
+
+    if (child == 0) {
+        close(report[0]);
+        _exit(run_config(config, seed, threads, report[1]) ?
+              EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(report[1]);
+    bool reported = (read(report[0], timings, sizeof(timings)) ==
+                     sizeof(timings));
+    close(report[0]);
+
+    if (wait4(child, &status, 0, &usage) != child || !reported ||
+        !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+        fprintf(stderr, "sim_bench: %u flights failed\n", config->flights);
+        return false;
+    }
+
+    double wall = timings[0] + timings[1];
+    uint32_t minutes = config->days * MINUTES_PER_DAY;
+
+    fprintf(results, "%u,%u,%u,%u,%u,%u,%llu,%u,%.6f,%.6f,%.6f,%.0f,%.0f,"
+                     "%ld\n",
+            config->flights, config->airports, config->planes, config->hubs,
+            config->hub_share, config->days, (unsigned long long)seed,
+            threads, timings[0], timings[1], wall, minutes / timings[1],
+            config->flights / wall, usage.ru_maxrss);
+    fflush(results);
+
+    fprintf(stderr, "%9u flights: %8.3f s, %10.0f simulated minutes/s, "
+                    "%8ld KiB peak\n",
+            config->flights, wall, minutes / timings[1], usage.ru_maxrss);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    enum {
+        OPT_FLIGHTS = 256,
+        OPT_AIRPORTS,
+        OPT_PLANES,
+        OPT_HUBS,
+        OPT_HUB_SHARE,
+        OPT_DAYS,
+        OPT_SEED,
+        OPT_MAX_FLIGHTS,
+        OPT_OUTPUT,
+        OPT_GENERATE
+    };
+
+    static const struct option options[] = {
+            {"threads",     required_argument, NULL, 'j'},
+            {"flights",     required_argument, NULL, OPT_FLIGHTS},
+            {"airports",    required_argument, NULL, OPT_AIRPORTS},
+            {"planes",      required_argument, NULL, OPT_PLANES},
+            {"hubs",        required_argument, NULL, OPT_HUBS},
+            {"hub-share",   required_argument, NULL, OPT_HUB_SHARE},
+            {"days",        required_argument, NULL, OPT_DAYS},
+            {"seed",        required_argument, NULL, OPT_SEED},
+            {"max-flights", required_argument, NULL, OPT_MAX_FLIGHTS},
+            {"output",      required_argument, NULL, OPT_OUTPUT},
+            {"generate",    no_argument,       NULL, OPT_GENERATE},
+            {NULL,          0,                 NULL, 0}
+    };
+
+    bench_config_t config = sweep[2];
+    unsigned long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long long seed = DEFAULT_SEED;
+    unsigned long max_flights = DEFAULT_MAX_FLIGHTS;
+    const char *output = DEFAULT_OUTPUT;
+    bool single = false, generate = false;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "j:", options, NULL)) != -1) {
+        unsigned long value = (optarg != NULL) ?
+                strtoul(optarg, NULL, 10) : 0;
+
+        switch (opt) {
+            case 'j': {
+                threads = value;
+            } break;
+
+            case OPT_FLIGHTS:
+            case OPT_AIRPORTS:
+            case OPT_PLANES:
+            case OPT_HUBS:
+            case OPT_HUB_SHARE: {
+                uint32_t *fields[] = {
+                        &config.flights, &config.airports, &config.planes,
+                        &config.hubs, &config.hub_share
+                };
+
+                *fields[opt - OPT_FLIGHTS] = value;
+                single = true;
+            } break;
+
+            case OPT_DAYS: {
+                config.days = value;
+            } break;
+
+            case OPT_SEED: {
+                seed = strtoull(optarg, NULL, 0);
+            } break;
+
+            case OPT_MAX_FLIGHTS: {
+                max_flights = value;
+            } break;
+
+            case OPT_OUTPUT: {
+                output = optarg;
+            } break;
+
+            case OPT_GENERATE: {
+                generate = true;
+            } break;
+
+            default: {
+                fprintf(stderr, "usage: %s [-j threads] [--flights N] "
+                                "[--airports N] [--planes N] [--hubs N] "
+                                "[--hub-share PERCENT] [--days N] "
+                                "[--seed S] [--max-flights N] "
+                                "[--output FILE] [--generate]\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (config.flights < 1 || config.airports < 2 ||
+        config.airports > AIRPORT_DIRECT_SIZE || config.planes < 1 ||
+        config.planes > PLANE_ID_MAX + 1 || config.hubs < 1 ||
+        config.hubs > config.airports || config.hub_share > 100 ||
+        config.days < 1 || config.days > SIMULATION_MAX_DAYS ||
+        threads < 1 || threads > WORKER_MAX_COUNT) {
+        fprintf(stderr, "%s: invalid configuration\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (generate) {
+        generate_schedule(stdout, &config, seed);
+        return (fflush(stdout) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    FILE *results = fopen(output, "w");
+
+    if (results == NULL) {
+        perror(output);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(results, "flights,airports,planes,hubs,hub_share,days,seed,"
+                     "threads,parse_s,simulate_s,wall_s,"
+                     "sim_minutes_per_s,flights_per_s,peak_rss_kib\n");
+
+    bool success = true;
+
+    if (single) {
+        success = bench_config(results, &config, seed, threads);
+    }
+
+    for (size_t i = 0; !single && i < sizeof(sweep) / sizeof(sweep[0]); i++) {
+        if (sweep[i].flights <= max_flights) {
+            success = bench_config(results, &sweep[i], seed, threads) &&
+                      success;
+        }
+    }
+
+    fclose(results);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
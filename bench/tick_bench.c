@@ -0,0 +1,317 @@
+/**
+ * @file    tick_bench.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details Benchmark of the event loop run every clock tick, comparing the
+ *          flight store split in columns against the single 64 byte flight
+ *          record it replaced, which held the carrier, the number and
+ *          pointers to the plane and airports next to the times and state.
+ *          Every flight goes through all of its states, from standing by to
+ *          complete, off the same event queue the simulation uses. Runways
+ *          are left out, so each flight takes off and lands as soon as it
+ *          asks to; only the cost of going through the flights is measured.
+ *
+ *          usage: tick_bench [flights] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "airport.h"
+#include "event.h"
+
+#define DEFAULT_FLIGHTS     1000000u
+#define DEFAULT_ROUNDS      5u
+#define FLIGHTS_PER_PLANE   4u
+
+/*
+ * The flight and plane records as they were before the flight store was
+ * split, with the same sizes and field order.
+ */
+typedef struct LegacyPlane {
+    uint32_t                id;
+    void*                   airport;
+    uint32_t                ready_at;
+    struct LegacyFlight*    waiting;
+} legacy_plane_t;
+
+typedef struct LegacyFlight {
+    char                    carrier[CARRIER_ID_STR_SIZE];
+    uint16_t                number;
+    legacy_plane_t*         plane;
+    void*                   origin;
+    void*                   destination;
+    flight_times_t          time;
+    flight_states_t         state;
+    uint8_t                 taxi_out;
+    uint8_t                 taxi_in;
+    uint8_t                 groom;
+    struct LegacyFlight*    next_waiting;
+} legacy_flight_t;
+
+typedef struct {
+    uint32_t    count;
+    uint32_t    planes;
+    uint32_t*   scheduled;
+    uint32_t*   duration;
+    uint8_t*    airports;   // Any two distinct ones will do
+} bench_schedule_t;
+
+/**
+ * @brief   Gives the time elapsed since a point in time.
+ * @param   [in] start: const struct timespec*
+ *                      -- Point in time to measure from.
+ * @return  double
+ *          -- Seconds elapsed since then.
+ */
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief   Finds the clock tick a flight is next due at, once it has moved
+ *          into a new state.
+ * @param   [in] state: flight_states_t
+ *                      -- State the flight just moved into.
+ * @param   [in] time: const flight_times_t*
+ *                     -- Times of the flight.
+ * @param   [in] taxi_out: uint32_t
+ * @param   [in] taxi_in: uint32_t
+ *                        -- Taxi durations of the flight.
+ * @return  uint32_t
+ *          -- Clock tick of the flight's next event, or NO_EVENT.
+ */
+static inline uint32_t next_due(flight_states_t state,
+                                const flight_times_t *time,
+                                uint32_t taxi_out, uint32_t taxi_in)
+{
+    switch (state) {
+        case DEPARTURE_TAXI: return time->departure + taxi_out;
+        case EN_ROUTE:       return time->departure + time->flight;
+        case ARRIVAL_TAXI:   return time->arrival + taxi_in;
+        default:             return NO_EVENT;
+    }
+}
+
+/**
+ * @brief   Runs every flight of the schedule through the event loop, with
+ *          the flights in single records.
+ * @param   [in] schedule: const bench_schedule_t*
+ *                         -- Schedule to run.
+ * @param   [in, out] events: event_queue_t*
+ *                            -- Empty event queue to run it on.
+ * @return  double
+ *          -- Seconds the event loop took.
+ */
+static double run_legacy(const bench_schedule_t *schedule,
+                         event_queue_t *events)
+{
+    legacy_flight_t *flights = calloc(schedule->count,
+                                      sizeof(legacy_flight_t));
+    legacy_plane_t *planes = calloc(schedule->planes, sizeof(legacy_plane_t));
+    struct timespec start;
+
+    for (uint32_t i = 0; i < schedule->count; i++) {
+        legacy_flight_t *flight = &flights[i];
+
+        flight->number         = (uint16_t)i;
+        flight->plane          = &planes[i % schedule->planes];
+        flight->origin         = &schedule->airports[0];
+        flight->destination    = &schedule->airports[1];
+        flight->time.scheduled = schedule->scheduled[i];
+        flight->time.flight    = schedule->duration[i];
+        flight->taxi_out       = TAXI_DURATION;
+        flight->taxi_in        = TAXI_DURATION;
+        flight->groom          = PLANE_GROOM_DURATION;
+        push_event(events, MAKE_EVENT(flight->time.scheduled, i));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (events->count > 0) {
+        sim_event_t event = pop_event(events);
+        uint32_t clock = EVENT_CLOCK(event);
+        legacy_flight_t *flight = &flights[EVENT_FLIGHT(event)];
+
+        switch (flight->state) {
+            case STAND_BY: {
+                // Planes are always ready here, but still have to be looked at.
+                if (flight->plane->ready_at <= clock) {
+                    flight->state = DEPARTURE_TAXI;
+                    flight->time.departure = clock;
+                }
+            } break;
+
+            case DEPARTURE_TAXI: {
+                flight->state = EN_ROUTE;
+                flight->plane->airport = NULL;
+                flight->time.departure = clock;
+            } break;
+
+            case EN_ROUTE: {
+                flight->state = ARRIVAL_TAXI;
+                flight->time.arrival = clock;
+            } break;
+
+            default: {
+                flight->state = COMPLETE;
+                flight->plane->airport = flight->destination;
+            } break;
+        }
+
+        uint32_t due = next_due(flight->state, &flight->time,
+                                flight->taxi_out, flight->taxi_in);
+
+        if (due != NO_EVENT) {
+            push_event(events, MAKE_EVENT(due, EVENT_FLIGHT(event)));
+        }
+    }
+
+    double seconds = elapsed(&start);
+    free(flights);
+    free(planes);
+    return seconds;
+}
+
+/**
+ * @brief   Runs every flight of the schedule through the event loop, with
+ *          the flights split in columns like the simulation keeps them.
+ * @param   [in] schedule: const bench_schedule_t*
+ *                         -- Schedule to run.
+ * @param   [in, out] events: event_queue_t*
+ *                            -- Empty event queue to run it on.
+ * @return  double
+ *          -- Seconds the event loop took.
+ */
+static double run_split(const bench_schedule_t *schedule,
+                        event_queue_t *events)
+{
+    flight_t *flights = calloc(schedule->count, sizeof(flight_t));
+    flight_info_t *info = calloc(schedule->count, sizeof(flight_info_t));
+    plane_t *planes = calloc(schedule->planes, sizeof(plane_t));
+    struct timespec start;
+
+    for (uint32_t i = 0; i < schedule->count; i++) {
+        flight_t *flight = &flights[i];
+
+        info[i].number         = (uint16_t)i;
+        info[i].next_waiting   = FLIGHT_NONE;
+        flight->plane          = i % schedule->planes;
+        flight->origin         = 0;
+        flight->destination    = 1;
+        flight->time.scheduled = schedule->scheduled[i];
+        flight->time.flight    = schedule->duration[i];
+        flight->taxi_out       = TAXI_DURATION;
+        flight->taxi_in        = TAXI_DURATION;
+        flight->groom          = PLANE_GROOM_DURATION;
+        push_event(events, MAKE_EVENT(flight->time.scheduled, i));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (events->count > 0) {
+        sim_event_t event = pop_event(events);
+        uint32_t clock = EVENT_CLOCK(event);
+        flight_t *flight = &flights[EVENT_FLIGHT(event)];
+
+        switch (flight->state) {
+            case STAND_BY: {
+                if (planes[flight->plane].ready_at <= clock) {
+                    flight->state = DEPARTURE_TAXI;
+                    flight->time.departure = clock;
+                }
+            } break;
+
+            case DEPARTURE_TAXI: {
+                flight->state = EN_ROUTE;
+                planes[flight->plane].airport = PLANE_ON_AIR;
+                flight->time.departure = clock;
+            } break;
+
+            case EN_ROUTE: {
+                flight->state = ARRIVAL_TAXI;
+                flight->time.arrival = clock;
+            } break;
+
+            default: {
+                flight->state = COMPLETE;
+                planes[flight->plane].airport = flight->destination;
+            } break;
+        }
+
+        uint32_t due = next_due(flight->state, &flight->time,
+                                flight->taxi_out, flight->taxi_in);
+
+        if (due != NO_EVENT) {
+            push_event(events, MAKE_EVENT(due, EVENT_FLIGHT(event)));
+        }
+    }
+
+    double seconds = elapsed(&start);
+    free(flights);
+    free(info);
+    free(planes);
+    return seconds;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t flights = (argc > 1) ? strtoul(argv[1], NULL, 10) :
+                       DEFAULT_FLIGHTS;
+    uint32_t rounds = (argc > 2) ? strtoul(argv[2], NULL, 10) :
+                      DEFAULT_ROUNDS;
+    static uint8_t airports[2];
+    bench_schedule_t schedule = {
+            .count     = flights,
+            .planes    = (flights + FLIGHTS_PER_PLANE - 1) / FLIGHTS_PER_PLANE,
+            .scheduled = malloc((size_t)flights * sizeof(uint32_t) + 1),
+            .duration  = malloc((size_t)flights * sizeof(uint32_t) + 1),
+            .airports  = airports
+    };
+    event_queue_t events;
+    double best[2] = {0.0, 0.0};
+
+    if (flights < 1 || rounds < 1 || schedule.scheduled == NULL ||
+        schedule.duration == NULL || !init_event_queue(&events, flights)) {
+        fprintf(stderr, "usage: %s [flights] [rounds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    srand(1);
+
+    for (uint32_t i = 0; i < flights; i++) {
+        schedule.scheduled[i] = rand() % MINUTES_PER_DAY;
+        schedule.duration[i] = 30 + rand() % 570;
+    }
+
+    // Both layouts take turns, so neither gets a warmer machine.
+    for (uint32_t r = 0; r < rounds; r++) {
+        double legacy = run_legacy(&schedule, &events);
+        double split = run_split(&schedule, &events);
+
+        best[0] = (r == 0 || legacy < best[0]) ? legacy : best[0];
+        best[1] = (r == 0 || split < best[1]) ? split : best[1];
+    }
+
+    // Every flight goes through four events: its departure, both taxis and
+    // its landing.
+    double events_run = 4.0 * flights;
+
+    printf("%u flights, best of %u rounds\n", flights, rounds);
+    printf("%-8s %14s %10s %10s\n", "layout", "bytes/flight", "seconds",
+           "ns/event");
+    printf("%-8s %14zu %10.4f %10.2f\n", "record", sizeof(legacy_flight_t),
+           best[0], best[0] * 1e9 / events_run);
+    printf("%-8s %9zu + %2zu %10.4f %10.2f\n", "columns", sizeof(flight_t),
+           sizeof(flight_info_t), best[1], best[1] * 1e9 / events_run);
+
+    deinit_event_queue(&events);
+    free(schedule.scheduled);
+    free(schedule.duration);
+    return EXIT_SUCCESS;
+}
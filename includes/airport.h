@@ -18,35 +18,43 @@
 #include <stdbool.h>
 #include <pthread.h>
 #include <sys/types.h>
+#include "arena.h"
 #include "queue.h"
+#include "event.h"
 
 #define EMPTY_QUEUE 0u
 #define QUEUE_TYPE_MASK 1u
 #define NEXT_QUEUE_TYPE(queue) ((queue + 1u) & QUEUE_TYPE_MASK)
 
 typedef struct {
+    uint16_t day;
     uint8_t hour;
     uint8_t minute;
 } atsim_time_t;
 
+#define HOURS_PER_DAY       24u
+#define MINUTES_PER_HOUR    60u
+#define MINUTES_PER_DAY     (HOURS_PER_DAY * MINUTES_PER_HOUR)
+
 #define TAXI_DURATION   10u
 
 #define PLANE_GROOM_DURATION  30u
-#define PLANE_ON_AIR          NULL
+#define PLANE_ON_AIR          AIRPORT_NONE
 
-atsim_time_t sim_ClockToTime(uint16_t clock);
+atsim_time_t sim_ClockToTime(uint32_t clock);
 uint32_t sim_TimeToClock(atsim_time_t time);
 
 bool init_airport(airport_t *airport);
 bool deinit_airport(airport_t *airport);
-void queue_departure(airport_t *airport, flight_t *flight);
-void queue_arrival(airport_t *airport, flight_t *flight);
-void manage_runway(airport_t *airport, uint16_t sim_clock);
+void queue_departure(airport_t *airport, uint32_t flight);
+void queue_arrival(airport_t *airport, uint32_t flight);
+void manage_runway(airport_t *airport, flight_t *flights, uint32_t sim_clock);
 
-bool update_flight(flight_t *flight, uint16_t sim_clock);
-void output_flight_log(flight_t *flight);
+bool update_flight(flight_t *flight, const arena_t *planes,
+                   uint32_t sim_clock);
+uint32_t next_flight_event(flight_t *flight);
 
-bool plane_ready(flight_t *flight);
+bool plane_ready(flight_t *flight, plane_t *plane, uint32_t sim_clock);
 
 
 #endif // ATSIM_AIRPORT_H
@@ -0,0 +1,59 @@
+/*
+ * File: arena.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures, constants and functions used by the arenas that store
+ *      the simulation's airports and planes.
+ *
+ */
+
+#ifndef ATSIM_ARENA_H
+#define ATSIM_ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Elements per chunk are kept between 2^8 and 2^16, picked from the
+// capacity hint the arena is initialized with.
+#define ARENA_CHUNK_SHIFT_MIN   8u
+#define ARENA_CHUNK_SHIFT_MAX   16u
+
+/*
+ * An arena grows one chunk at a time and never moves its elements, so
+ * pointers to them stay valid while the arena keeps growing.
+ */
+typedef struct Arena {
+    uint8_t**   chunks;
+    uint32_t    chunk_count;
+    uint32_t    chunk_capacity;
+    uint32_t    chunk_shift;
+    uint32_t    element_size;
+    uint32_t    count;
+} arena_t;
+
+bool init_arena(arena_t *arena, uint32_t element_size, uint32_t capacity_hint);
+void deinit_arena(arena_t *arena);
+void arena_reset(arena_t *arena);
+void* arena_push(arena_t *arena);
+bool arena_grow(arena_t *arena, uint32_t count);
+
+/**
+ * @brief   Finds an element of an arena.
+ * @param   [in] arena: const arena_t*
+ *                      -- Pointer to an arena data type.
+ * @param   [in] index: uint32_t
+ *                      -- Index of an element below the arena's count.
+ * @return  void*
+ *          -- Pointer to the element.
+ */
+static inline void* arena_at(const arena_t *arena, uint32_t index)
+{
+    uint32_t mask = (1u << arena->chunk_shift) - 1u;
+
+    return arena->chunks[index >> arena->chunk_shift] +
+           (size_t)(index & mask) * arena->element_size;
+}
+
+#endif //ATSIM_ARENA_H
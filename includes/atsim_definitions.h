@@ -6,22 +6,60 @@
 #define ATSIM_DEFINITIONS_H
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <sys/types.h>
 #include "airport.h"
+#include "arena.h"
+#include "barrier.h"
+#include "output.h"
 
-// Plane, Flight and airport count are easily scalable as the simulation
-// requirements grows.
-#define PLANE_MAX_COUNT     1000
-#define FLIGHT_MAX_COUNT    1000
-#define AIRPORT_MAX_COUNT   256
+// Plane, Flight and airport stores grow with the input. These are only the
+// capacities they're sized for when no hint is given.
+#define PLANE_CAPACITY_HINT     1024u
+#define FLIGHT_CAPACITY_HINT    1024u
+#define AIRPORT_CAPACITY_HINT   256u
 
-// Shortest valid flight input looks like this: (X being placeholder characters)
-// X X X X X:X X X
-// = 15 total characters (including whitespace)
-#define FLIGHT_DATA_MIN_SIZE    15
-#define FLIGHT_DATA_MAX_SIZE    100
+// Flights completed within a window are held until the window is over.
+#define COMPLETED_CAPACITY_HINT 64u
 
-#define SIMULATION_MAX_TIME 24*60
+// Planes are stored by their ID, so IDs are kept within a sane range.
+#define PLANE_ID_MAX            0xFFFFFFu
+
+#define WORKER_MAX_COUNT    256
+#define WORKER_CACHE_LINE   64
+#define WORKER_NONE         UINT16_MAX
+
+// The ticks of a window each worker went through are kept in a 64-bit mask.
+#define WINDOW_MAX_TICKS    64u
+
+// Codes made of three uppercase letters index a table directly.
+#define AIRPORT_CODE_LETTERS    26u
+#define AIRPORT_DIRECT_SIZE     (AIRPORT_CODE_LETTERS * AIRPORT_CODE_LETTERS * \
+                                 AIRPORT_CODE_LETTERS)
+#define AIRPORT_HASH_MIN_SIZE   64u
+
+// The schedule is read in blocks of this size, which also bounds the length
+// of a line.
+#define SCHEDULE_READ_SIZE      (1u << 20)
+
+// The simulation runs for a single day unless asked to run for longer.
+// Day qualified times keep their day in 16 bits.
+#define SIMULATION_DEFAULT_DAYS 1u
+#define SIMULATION_MAX_DAYS     UINT16_MAX
+
+#define AIRPORT(sim_param, i)   ((airport_t *)arena_at(&(sim_param)->airports, i))
+#define PLANE(sim_param, i)     ((plane_t *)arena_at(&(sim_param)->planes, i))
+
+/*
+ * Results are ordered by completion time, then carrier code, then flight
+ * number. Packing them in that order, with the carrier's characters compared
+ * as unsigned bytes like memcmp does, orders the keys the same way.
+ */
+#define RESULT_KEY(flight, info) \
+    (((uint64_t)(flight)->time.arrival << 32) | \
+     ((uint64_t)(uint8_t)(info)->carrier[0] << 24) | \
+     ((uint64_t)(uint8_t)(info)->carrier[1] << 16) | \
+     (uint64_t)(info)->number)
 
 typedef enum {
     READ_FLIGHT_INFO = 0u,
@@ -29,19 +67,113 @@ typedef enum {
     SIMULATION_COMPLETE
 } simulation_states_t;
 
+/*
+ * Each worker owns a share of the airports and planes, along with the
+ * flights at them: a flight belongs to its plane's worker while it stands by
+ * or taxis in, to its origin's while it taxis out and waits to take off,
+ * and to its destination's while it's en route and waits to land.
+ * A worker keeps the events of its own flights, and the list of its own
+ * runways in use, and goes through the ticks of a window on a clock of its
+ * own.
+ * Flights moving on to another worker are handed over through that worker's
+ * inbox, and so are the flights that took off with its planes from another
+ * worker's airport. Every worker may send to an inbox, but only its owner
+ * takes from it.
+ * Every worker sits on cache lines of its own, as it's written to on every
+ * tick it goes through, and its mailboxes sit on lines apart from the rest
+ * of it, as every other worker writes to them.
+ */
+typedef struct Worker {
+    _Alignas(WORKER_CACHE_LINE)
+    event_queue_t               events;     // Events of the worker's flights
+    uint32_t*                   due;        // Flights due on this tick
+    airport_t**                 runways;    // Its runways in use
+    uint32_t                    runway_count;
+    uint32_t*                   completed;  // Flights completed in a window
+    uint32_t                    completed_count;
+    uint32_t                    completed_capacity;
+    bool                        failed;     // Ran out of memory
+    uint32_t                    clock;      // Tick it's going through
+    uint32_t                    sent_clock; // Earliest event handed over
+    uint32_t                    next_clock; // Next tick it has work due on
+    uint64_t                    worked;     // Ticks of the window it worked
+    struct SimulationParam*     sim_param;  // Simulation the worker serves
+    struct WorkerStats*         stats;      // Counted into when not NULL
+    pthread_t                   thread;
+    flight_mailbox_t            inbox;      // Flights handed over to it
+    flight_mailbox_t            takeoffs;   // Flights its planes took off on
+    event_queue_t               departed;   // Its planes by when they're up
+    uint32_t                    abroad;     // Takeoffs it wasn't told of yet
+} worker_t;
+
+/*
+ * Interns airport codes in constant time.
+ * Entries hold the airport's index plus one, so zero marks an unused entry.
+ * Any code that isn't three uppercase letters goes through an open
+ * addressing hash table keyed on its packed characters instead.
+ */
 typedef struct {
-    plane_t             planes[PLANE_MAX_COUNT];
-    flight_t            flights[FLIGHT_MAX_COUNT];
-    airport_t           airports[AIRPORT_MAX_COUNT];
-    pthread_t           airport_threads[AIRPORT_MAX_COUNT];
-    pthread_barrier_t   airport_start_sync;
-    pthread_barrier_t   airport_end_sync;
-    uint16_t            flight_count;
-    uint16_t            airport_count;
+    uint32_t*   direct;
+    uint32_t*   hash_keys;
+    uint32_t*   hash_airports;
+    uint32_t    hash_mask;
+    uint32_t    hash_count;
+} airport_index_t;
+
+/*
+ * Flights are only ever referred to by their index, so they're kept in
+ * arrays that are reallocated as they grow, one per column of the flight.
+ * Airports and planes are pointed to while the input is still being read,
+ * so they live in arenas, which never move them.
+ */
+typedef struct SimulationParam {
+    arena_t             planes;
+    arena_t             airports;
+    airport_index_t     airport_index;
+    flight_t*           flights;
+    flight_info_t*      flight_info;    // Same index as the flights
+    uint16_t*           plane_workers;  // Same index as the planes
+    uint32_t*           plane_takeoffs; // Not told of yet, same index
+    airport_t**         runway_airports;    // Every worker's, for checkpoints
+    worker_t            workers[WORKER_MAX_COUNT];
+    sim_barrier_t       airport_start_sync;
+    sim_barrier_t       airport_end_sync;
+    event_queue_t       events;     // Every worker's, for checkpoints
+    output_t            output;
+    uint32_t*           completed;
+    uint32_t            completed_count;
+    uint32_t            completed_capacity;
+    uint32_t            flight_count;
+    uint32_t            flight_capacity;
+    uint32_t            runway_count;
+    uint16_t            worker_count;
     uint32_t            clock;
+    uint32_t            lookahead;  // Most ticks a window may span
+    uint32_t            window_end; // Tick the current window stops before
+    uint32_t            horizon;    // Last clock tick that is simulated
     simulation_states_t state;
     bool                complete;
     bool                thread_done;
+    bool                stream;
+    const char*         schedule_path;  // Compiled schedule to load, if any
+    const char*         compile_path;   // Where to compile the schedule to
+    const char*         checkpoint_path;    // Where to save a checkpoint to
+    uint32_t            checkpoint_at;      // Clock the checkpoint is due at
+    const char*         restore_path;       // Checkpoint to resume from
+    uint32_t            store_hints[3];     // Flights, airports and planes
+    char**              batch_paths;        // Schedules to run as a batch
+    uint32_t            batch_count;
+    uint32_t            replicates;         // Monte Carlo replicates to run
+    uint32_t            spread;             // Of the durations, in percent
+    uint64_t            seed;
+    uint32_t*           completions;    // Completion clocks, output instead
+    struct Stats*       stats;          // Counted into when not NULL
+    const char*         stats_path;     // Where the stats go, or stderr
+    bool                runway_report;  // Records each runway's metrics
+    const char*         runway_report_path; // Where they go, or stderr
+    struct RunwayMetrics*   runway_metrics; // One per airport, when recorded
+    uint32_t            first_clock;    // First tick simulated
+    uint32_t            last_clock;     // Last tick simulated, if any
 } simulation_param_t;
 
 #endif //ATSIM_DEFINITIONS_H
@@ -0,0 +1,58 @@
+/*
+ * File: barrier.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures, constants and functions used by the barrier that
+ *      synchronizes the main thread and the airport workers every tick.
+ *
+ */
+
+#ifndef ATSIM_BARRIER_H
+#define ATSIM_BARRIER_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// Number of times a thread checks the barrier before going to sleep on it.
+#define BARRIER_SPIN_LIMIT  4096u
+
+/*
+ * Sense-reversing barrier.
+ * Threads spin on the sense for a bounded time and only then sleep on it,
+ * so a tick that is quickly over never costs a system call.
+ * When there are more participants than processors, spinning would only
+ * delay the threads that still have to arrive, so they sleep right away.
+ */
+typedef struct SpinBarrier {
+    _Atomic uint32_t    count;      // Threads yet to arrive this round
+    _Atomic uint32_t    sense;      // Flipped by the last thread to arrive
+    _Atomic uint32_t    sleepers;   // Threads sleeping on the sense
+    uint32_t            participants;
+    uint32_t            spin_limit;
+} spin_barrier_t;
+
+int spin_barrier_init(spin_barrier_t *barrier, uint32_t participants);
+int spin_barrier_wait(spin_barrier_t *barrier);
+int spin_barrier_destroy(spin_barrier_t *barrier);
+
+/*
+ * The barrier used by the simulation is picked at build time.
+ * Both return PTHREAD_BARRIER_SERIAL_THREAD to a single thread per round.
+ */
+#ifdef ATSIM_SPIN_BARRIER
+typedef spin_barrier_t sim_barrier_t;
+#define sim_barrier_init(barrier, count)    spin_barrier_init(barrier, count)
+#define sim_barrier_wait(barrier)           spin_barrier_wait(barrier)
+#define sim_barrier_destroy(barrier)        spin_barrier_destroy(barrier)
+#else
+typedef pthread_barrier_t sim_barrier_t;
+#define sim_barrier_init(barrier, count) \
+    pthread_barrier_init(barrier, NULL, count)
+#define sim_barrier_wait(barrier)           pthread_barrier_wait(barrier)
+#define sim_barrier_destroy(barrier)        pthread_barrier_destroy(barrier)
+#endif
+
+#endif //ATSIM_BARRIER_H
@@ -0,0 +1,48 @@
+/*
+ * File: batch.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures, constants and functions used to run a batch of
+ *      independent schedules concurrently.
+ *
+ */
+
+#ifndef ATSIM_BATCH_H
+#define ATSIM_BATCH_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "atsim_definitions.h"
+
+// The results of each schedule go next to it, under its name plus this.
+#define BATCH_OUTPUT_SUFFIX ".out"
+
+/*
+ * The schedules are handed out one at a time to whichever thread is free,
+ * so a long schedule doesn't hold back the ones queued behind it.
+ */
+typedef struct Batch {
+    char**              paths;
+    uint32_t            count;
+    _Atomic uint32_t    next;       // Next schedule to be handed out
+    _Atomic uint32_t    failed;     // Schedules that couldn't be simulated
+} batch_t;
+
+/*
+ * Every thread of the batch owns a simulation that it reuses for each
+ * schedule it's handed, so its stores only grow to fit the largest one.
+ */
+typedef struct {
+    simulation_param_t  sim;
+    batch_t*            batch;
+    pthread_t           thread;
+} batch_worker_t;
+
+bool run_batch(const simulation_param_t *options);
+bool run_batch_entry(simulation_param_t *sim_param, const char *path);
+void* batch_worker(void *arg);
+
+#endif //ATSIM_BATCH_H
@@ -0,0 +1,74 @@
+/*
+ * File: checkpoint.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures, constants and functions used to save the state of a
+ *      running simulation and resume it later.
+ *
+ */
+
+#ifndef ATSIM_CHECKPOINT_H
+#define ATSIM_CHECKPOINT_H
+
+#include "atsim_definitions.h"
+
+#define CHECKPOINT_MAGIC    "ATCK"
+#define CHECKPOINT_VERSION  2u
+#define CHECKPOINT_NONE     UINT32_MAX  // Stands in for no flight or airport
+
+/*
+ * A checkpoint only holds what changes while the simulation runs, taken
+ * between two clock ticks. The schedule itself is read again on restore, and
+ * the fingerprint makes sure it is the one the checkpoint was taken from.
+ * It is laid out as, in the machine's byte order:
+ *      header
+ *      flights             checkpoint_flight_t per flight, in flight order
+ *      planes              checkpoint_plane_t per plane, in store order
+ *      airports            checkpoint_airport_t per airport, in store order
+ *      queued flights      uint32 flight index per queued flight, airport by
+ *                          airport, departures first
+ *      runways in use      uint32 airport index per runway
+ *      padding             zeros up to the alignment of an event key
+ *      events              event key per pending event, in heap order
+ * Pointers are written as the index of what they point to.
+ */
+typedef struct {
+    char        magic[4];
+    uint32_t    version;
+    uint64_t    fingerprint;
+    uint32_t    clock;
+    uint32_t    flight_count;
+    uint32_t    airport_count;
+    uint32_t    plane_count;
+    uint32_t    queued_count;
+    uint32_t    runway_count;
+    uint32_t    event_count;
+    uint32_t    reserved;
+} checkpoint_header_t;
+
+typedef struct {
+    uint32_t    departure;
+    uint32_t    arrival;
+    uint32_t    next_waiting;
+    uint32_t    state;
+} checkpoint_flight_t;
+
+typedef struct {
+    uint32_t    airport;
+    uint32_t    ready_at;
+    uint32_t    waiting;
+} checkpoint_plane_t;
+
+typedef struct {
+    uint32_t    departures;     // Flights in the departure queue
+    uint32_t    arrivals;       // Flights in the arrival queue
+    uint32_t    last_queue_type;
+    uint32_t    runway_active;
+} checkpoint_airport_t;
+
+bool write_checkpoint(simulation_param_t *sim_param, const char *path);
+bool load_checkpoint(simulation_param_t *sim_param, const char *path);
+
+#endif //ATSIM_CHECKPOINT_H
@@ -0,0 +1,51 @@
+/*
+ * File: event.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures, constants and functions used by the simulation's
+ *      event queue, which lets the simulation clock jump straight to the
+ *      next clock tick where something can happen.
+ *
+ */
+
+#ifndef ATSIM_EVENT_H
+#define ATSIM_EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Events are packed into a single 64 bit key: the clock tick the event is
+ * due at sits in the upper half and the index of the flight that raised it in
+ * the lower half. Ordering the keys as plain integers then orders events by
+ * time first and by flight second.
+ */
+typedef uint64_t sim_event_t;
+
+#define EVENT_CLOCK_SHIFT       32u
+#define EVENT_FLIGHT_MASK       0xFFFFFFFFu
+#define MAKE_EVENT(clock, flight) \
+    (((sim_event_t)(clock) << EVENT_CLOCK_SHIFT) | ((flight) & EVENT_FLIGHT_MASK))
+#define EVENT_CLOCK(event)      ((uint32_t)((event) >> EVENT_CLOCK_SHIFT))
+#define EVENT_FLIGHT(event)     ((uint32_t)((event) & EVENT_FLIGHT_MASK))
+
+#define NO_EVENT    UINT32_MAX
+#define EVENT_NONE  UINT64_MAX
+
+typedef struct EventQueue {
+    sim_event_t*    heap;
+    uint32_t        count;
+    uint32_t        capacity;
+} event_queue_t;
+
+bool init_event_queue(event_queue_t *queue, uint32_t capacity);
+void deinit_event_queue(event_queue_t *queue);
+bool reset_event_queue(event_queue_t *queue, uint32_t capacity);
+bool push_event(event_queue_t *queue, sim_event_t event);
+sim_event_t pop_event(event_queue_t *queue);
+uint32_t next_event_clock(event_queue_t *queue);
+sim_event_t next_event(event_queue_t *queue);
+
+#endif //ATSIM_EVENT_H
@@ -0,0 +1,21 @@
+/*
+ * File: file.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations of the functions used to read
+ *      and write the simulation's binary files whole.
+ *
+ */
+
+#ifndef ATSIM_FILE_H
+#define ATSIM_FILE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+const void* map_file(const char *path, size_t *size);
+void unmap_file(const void *data, size_t size);
+bool write_file(const char *path, const void *data, size_t size);
+
+#endif //ATSIM_FILE_H
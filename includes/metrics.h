@@ -0,0 +1,51 @@
+/*
+ * File: metrics.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures and functions used to record how each airport's runway
+ *      is used, when asked to, and to report it once the simulation is over.
+ *
+ */
+
+#ifndef ATSIM_METRICS_H
+#define ATSIM_METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "atsim_definitions.h"
+
+#define METRICS_CACHE_LINE      64
+
+// Queue depths are counted in power of 2 buckets: 0, 1, 2-3, 4-7, and so on,
+// with the last bucket holding everything past the one before it.
+#define METRICS_DEPTH_BUCKETS   9
+
+/*
+ * An airport's metrics are only ever written by the worker serving its
+ * runway, so they're recorded without locks, and each airport's sit on cache
+ * lines of their own so workers serving neighbouring airports don't contend
+ * over them.
+ * A runway is only served on the minutes it has flights waiting, and it uses
+ * up one of them every time, so the minutes it isn't served are the ones
+ * both queues are empty on. They're only counted into the depth histograms
+ * once the simulation is over.
+ */
+typedef struct RunwayMetrics {
+    _Alignas(METRICS_CACHE_LINE) uint32_t served[QUEUE_TYPES];
+    uint32_t    alternations;   // Flights served from the other queue
+    uint32_t    max_wait[QUEUE_TYPES];
+    uint64_t    total_wait[QUEUE_TYPES];
+    uint32_t    depth[QUEUE_TYPES][METRICS_DEPTH_BUCKETS];
+} runway_metrics_t;
+
+bool init_runway_metrics(simulation_param_t *sim_param);
+void record_runway_use(runway_metrics_t *metrics, flight_queue_t **queues,
+                       queue_types_t served, bool alternated,
+                       flight_t *flight, uint32_t sim_clock);
+bool write_runway_report(const simulation_param_t *sim_param,
+                         const char *path);
+
+#endif // ATSIM_METRICS_H
@@ -0,0 +1,58 @@
+/*
+ * File: montecarlo.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures, constants and functions used to run replicates of a
+ *      schedule with randomly perturbed durations and report the spread of
+ *      the delays they end up with.
+ *
+ */
+
+#ifndef ATSIM_MONTECARLO_H
+#define ATSIM_MONTECARLO_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "atsim_definitions.h"
+
+#define MONTE_CARLO_DEFAULT_SEED    1u
+#define MONTE_CARLO_DEFAULT_SPREAD  10u     // Percent
+#define MONTE_CARLO_MAX_SPREAD      100u
+
+/*
+ * The schedule is parsed once and only ever read by the replicates, which
+ * copy it into stores of their own before perturbing it.
+ * Each replicate records the clock every flight completed at into its own
+ * row of the completions, NO_EVENT if it never did.
+ */
+typedef struct MonteCarlo {
+    const simulation_param_t*   schedule;
+    uint32_t*                   completions;    // Replicate by replicate
+    uint32_t                    replicates;
+    uint32_t                    spread;
+    uint64_t                    seed;
+    _Atomic uint32_t            next;       // Next replicate to be handed out
+    _Atomic uint32_t            failed;     // Replicates that couldn't run
+} monte_carlo_t;
+
+/*
+ * Every thread owns a simulation that it reuses for each replicate.
+ */
+typedef struct {
+    simulation_param_t  sim;
+    monte_carlo_t*      monte_carlo;
+    pthread_t           thread;
+} replicate_worker_t;
+
+bool run_monte_carlo(simulation_param_t *sim_param, int input_fd);
+void* replicate_worker(void *arg);
+bool run_replicate(simulation_param_t *sim_param,
+                   const monte_carlo_t *monte_carlo, uint32_t replicate);
+void perturb_schedule(simulation_param_t *sim_param, uint64_t seed,
+                      uint32_t replicate, uint32_t spread);
+bool output_delay_report(const monte_carlo_t *monte_carlo, output_t *output);
+
+#endif //ATSIM_MONTECARLO_H
@@ -0,0 +1,51 @@
+/*
+ * File: output.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures, constants and functions used to write the simulation's
+ *      results without going through stdio.
+ *
+ */
+
+#ifndef ATSIM_OUTPUT_H
+#define ATSIM_OUTPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "queue.h"
+
+#define OUTPUT_BUFFER_SIZE      (1u << 20)
+
+// Longest line a single flight log can take, with every field at its widest.
+#define OUTPUT_LINE_MAX         160u
+
+// Clock values with a precomputed "HH:MM", a day and the hour after it.
+#define OUTPUT_TIME_TABLE_SIZE  (25u * 60u)
+#define OUTPUT_TIME_LENGTH      5u
+
+/*
+ * Results are formatted straight into the buffer, which is only handed to
+ * the file descriptor once it is nearly full or when it is flushed.
+ */
+typedef struct Output {
+    char*   buffer;
+    size_t  length;
+    size_t  capacity;
+    int     fd;
+    bool    failed;
+    bool    day_times;  // Times are written as D:HH:MM
+} output_t;
+
+bool init_output(output_t *output, int fd, size_t capacity, bool day_times);
+bool deinit_output(output_t *output);
+void output_redirect(output_t *output, int fd);
+bool output_flush(output_t *output);
+void output_flight_log(output_t *output, const flight_t *flight,
+                       const flight_info_t *info, const airport_t *origin,
+                       const airport_t *destination);
+void output_text(output_t *output, const char *format, ...);
+
+#endif //ATSIM_OUTPUT_H
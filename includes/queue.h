@@ -6,6 +6,10 @@
  *      This file contains the declarations and definitions of the
  *      structures, constants and functions used by the flight queue
  *      or used to manage the flight queue.
+ *      The flight queue is a lock-free ring buffer that any number of
+ *      threads can enqueue into, but that only its owning airport
+ *      may take flights out of. The flight mailbox is the same ring laid
+ *      out for the queues workers hand flights to each other through.
  *
  */
 
@@ -14,7 +18,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <pthread.h>
+#include <stdatomic.h>
 #include <sys/types.h>
 
 typedef enum {
@@ -28,36 +32,90 @@ typedef enum {
 } flight_states_t;
 
 typedef struct {
-    uint16_t scheduled;
-    uint16_t flight;
-    uint16_t departure;
-    uint16_t arrival;
+    uint32_t scheduled;
+    uint32_t flight;
+    uint32_t departure;
+    uint32_t arrival;
 } flight_times_t;
 
 #define CARRIER_ID_LENGTH     2
 #define CARRIER_ID_STR_SIZE   CARRIER_ID_LENGTH+1
 
+// Flights, airports and planes refer to each other by their index in their
+// store, with this marking a reference to none.
+#define FLIGHT_NONE     UINT32_MAX
+#define AIRPORT_NONE    UINT32_MAX
+
+/*
+ * A flight is split in two columns of the flight store. This one holds what
+ * every event of the flight goes through, and is kept to 32 bytes so two
+ * flights share a cache line.
+ */
 typedef struct Flight {
-    char                carrier[CARRIER_ID_STR_SIZE];
-    uint16_t            number;
-    struct Plane*       plane;
-    struct Airport*     origin;     // This solves circular dependency
-    struct Airport*     destination;
     flight_times_t      time;
-    flight_states_t     state;
+    uint32_t            plane;      // Index of the plane in its store
+    uint32_t            origin;     // Index of the airport in its store
+    uint32_t            destination;
+    uint8_t             state;      // One of flight_states_t
+    uint8_t             taxi_out;   // Minutes taxiing out to the runway
+    uint8_t             taxi_in;    // Minutes taxiing in from the runway
+    uint8_t             groom;      // Minutes grooming the plane once landed
 } flight_t;
 
+/*
+ * The other column holds what identifies the flight, which is only looked
+ * at when its results are written, and the link of the list of flights
+ * waiting on a plane, which is only followed when a plane lands.
+ */
+typedef struct FlightInfo {
+    char                carrier[CARRIER_ID_STR_SIZE];
+    uint16_t            number;
+    uint32_t            next_waiting;   // Next flight waiting on the plane
+} flight_info_t;
+
 
-#define FLIGHT_QUEUE_SIZE   256u
-#define FLIGHT_QUEUE_SIZE_MASK  FLIGHT_QUEUE_SIZE-1u
+/*
+ * Each slot carries a sequence number that tells producers and the consumer
+ * whose turn it is to use the slot, which is what lets the queue work
+ * without a lock: a slot is free for the producer that reserved position n
+ * when its sequence is n, and holds a flight for the consumer when it is n+1.
+ */
+typedef struct FlightQueueSlot {
+    _Atomic uint32_t    sequence;
+    uint32_t            flight;     // Index of the flight in its store
+} flight_queue_slot_t;
 
+/*
+ * The buffer's size is a power of 2 picked when the queue is initialized,
+ * so positions are mapped to their slot by masking them with size - 1.
+ */
 typedef struct FlightQueue {
-    uint32_t    head;
-    uint32_t    tail;
-    flight_t*   buffer[FLIGHT_QUEUE_SIZE];
-    pthread_mutex_t mutex;
+    _Atomic uint32_t        head;   // Only ever written by the consumer
+    _Atomic uint32_t        tail;   // Reserved by producers
+    uint32_t                mask;
+    flight_queue_slot_t*    buffer;
 } flight_queue_t;
 
+#define QUEUE_CACHE_LINE    64
+
+/*
+ * A flight queue is packed into its airport, and only the airport's worker
+ * ever queues flights at it. A worker's mailboxes are
+ * written to by every other worker while their owner drains them, so the
+ * head and the tail each get a cache line, with the producers reading their
+ * own copy of the mask and the buffer next to the tail.
+ */
+typedef struct FlightMailbox {
+    _Alignas(QUEUE_CACHE_LINE)
+    _Atomic uint32_t        head;   // Only ever written by the consumer
+    uint32_t                mask;
+    flight_queue_slot_t*    buffer;
+    _Alignas(QUEUE_CACHE_LINE)
+    _Atomic uint32_t        tail;   // Reserved by producers
+    uint32_t                tail_mask;
+    flight_queue_slot_t*    tail_buffer;
+} flight_mailbox_t;
+
 
 typedef enum QueueTypes {
     DEPARTURE,
@@ -68,23 +126,48 @@ typedef enum QueueTypes {
 #define CODE_LENGTH     3
 #define CODE_STR_SIZE   CODE_LENGTH+1 // account for the Null termination
 
+/*
+ * An airport belongs to a single worker, which queues its flights, serves
+ * its runway and keeps track of whether the runway is in use.
+ */
 typedef struct Airport {
     flight_queue_t  departures_queue;
     flight_queue_t  arrivals_queue;
     char            code[CODE_STR_SIZE];
+    uint32_t        id;             // Index of the airport in its store
     queue_types_t   last_queue_type;
-    pthread_t       thread;
+    uint32_t        runway_flight;  // Flight that used the runway last tick
+    bool            runway_active;  // Has flights queued for the runway
+    uint32_t        departure_count;    // Flights departing from the airport
+    uint32_t        arrival_count;      // Flights arriving at the airport
+    uint16_t        worker;         // Worker that owns the airport
+    struct RunwayMetrics*   metrics;    // Recorded into when not NULL
 } airport_t;
 
+/*
+ * A plane belongs to a single worker, which checks it for the flights
+ * standing by and moves it as they land. Other workers only ever tell it
+ * the plane took off. Owners are kept apart from the planes, as they're
+ * only looked up when a flight changes hands.
+ */
 typedef struct Plane {
-    airport_t*  airport;
-    uint16_t    groom;
+    uint32_t    id;
+    uint32_t    airport;    // Where the plane is, or PLANE_ON_AIR
+    uint32_t    ready_at;   // Clock tick the plane is done grooming at
+    uint32_t    waiting;    // Flights waiting for the plane to land
 } plane_t;
 
-int init_queue (flight_queue_t * queue);
-void dequeue(flight_queue_t *queue);
-void enqueue(flight_queue_t *queue, flight_t *flight);
-flight_t* peek(flight_queue_t *queue);
+int init_queue (flight_queue_t * queue, uint32_t capacity);
+void deinit_queue(flight_queue_t *queue);
+bool enqueue(flight_queue_t *queue, uint32_t flight);
+uint32_t try_pop(flight_queue_t *queue);
 uint32_t size (flight_queue_t * queue);
+uint32_t peek_queue(flight_queue_t *queue, uint32_t index);
+
+int init_mailbox(flight_mailbox_t *mailbox, uint32_t capacity);
+void deinit_mailbox(flight_mailbox_t *mailbox);
+bool mailbox_enqueue(flight_mailbox_t *mailbox, uint32_t flight);
+uint32_t mailbox_try_pop(flight_mailbox_t *mailbox);
+uint32_t mailbox_size(flight_mailbox_t *mailbox);
 
 #endif //ATSIM_QUEUE_H
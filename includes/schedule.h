@@ -0,0 +1,33 @@
+/*
+ * File: schedule.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations of the functions used to build
+ *      the simulation's schedule from the input.
+ *
+ */
+
+#ifndef ATSIM_SCHEDULE_H
+#define ATSIM_SCHEDULE_H
+
+#include "atsim_definitions.h"
+
+bool init_stores(simulation_param_t *sim_param, uint32_t flights,
+                 uint32_t airports, uint32_t planes);
+void deinit_stores(simulation_param_t *sim_param);
+void reset_stores(simulation_param_t *sim_param);
+bool copy_schedule(simulation_param_t *sim_param,
+                   const simulation_param_t *source);
+bool grow_flights(simulation_param_t *sim_param, uint32_t capacity);
+uint32_t add_flight(simulation_param_t *sim_param);
+flight_t* insert_flight(simulation_param_t *sim_param, const flight_t *entry,
+                        const char *carrier, uint16_t number);
+plane_t* find_plane(simulation_param_t *sim_param, uint32_t id);
+airport_t* find_airport(simulation_param_t *sim_param, const char *code);
+bool configure_simulation_data(simulation_param_t *sim_param, const char *data,
+                               size_t length);
+bool read_schedule(simulation_param_t *sim_param, int fd);
+bool sort_flights(simulation_param_t *sim_param);
+
+#endif //ATSIM_SCHEDULE_H
@@ -0,0 +1,47 @@
+/*
+ * File: schedule_file.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures, constants and functions used by compiled schedule files,
+ *      which hold an already parsed schedule.
+ *
+ */
+
+#ifndef ATSIM_SCHEDULE_FILE_H
+#define ATSIM_SCHEDULE_FILE_H
+
+#include "atsim_definitions.h"
+
+#define SCHEDULE_FILE_MAGIC     "ATSB"
+#define SCHEDULE_FILE_VERSION   1u
+
+/*
+ * A compiled schedule is laid out as, in the machine's byte order:
+ *      header
+ *      airport codes       char[4] per airport, in store order
+ *      carrier codes       char[4] per carrier
+ *      flight columns      one array per field, in input order:
+ *                          number (uint16), carrier (uint16), plane,
+ *                          origin, destination, scheduled time and
+ *                          flight duration (uint32)
+ * Every section starts on a 4 byte boundary, so the columns can be read in
+ * place once the file is mapped. Airports and carriers are referred to by
+ * their index in their table.
+ */
+typedef struct {
+    char        magic[4];
+    uint32_t    version;
+    uint32_t    flight_count;
+    uint32_t    airport_count;
+    uint32_t    carrier_count;
+    uint32_t    reserved;
+} schedule_file_header_t;
+
+#define SCHEDULE_FILE_CODE_SIZE 4u
+
+bool write_schedule_file(simulation_param_t *sim_param, const char *path);
+bool load_schedule_file(simulation_param_t *sim_param, const char *path);
+
+#endif //ATSIM_SCHEDULE_FILE_H
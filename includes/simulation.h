@@ -0,0 +1,44 @@
+/*
+ * File: simulation.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations of the functions used to run a
+ *      simulation over its own parameters, with a pool of workers that
+ *      each run the airports they own through windows of clock ticks.
+ *
+ */
+
+#ifndef ATSIM_SIMULATION_H
+#define ATSIM_SIMULATION_H
+
+#include "atsim_definitions.h"
+
+bool run_simulation(simulation_param_t *sim_param, int input_fd);
+bool load_schedule(simulation_param_t *sim_param, int input_fd);
+bool prepare_workers(simulation_param_t *sim_param);
+worker_t* flight_worker(simulation_param_t *sim_param, flight_t *flight);
+void hand_out_events(simulation_param_t *sim_param);
+void gather_workers(simulation_param_t *sim_param);
+bool run_window(simulation_param_t *sim_param);
+bool run_worker_window(worker_t *worker);
+bool run_worker_tick(worker_t *worker, bool check);
+bool planes_settled(worker_t *worker, uint32_t count);
+void update_due_flight(worker_t *worker, uint32_t index);
+void update_released_flights(worker_t *worker, sim_event_t until);
+void receive_flights(worker_t *worker);
+void take_off_planes(worker_t *worker);
+void schedule_flight(worker_t *worker, uint32_t index);
+void post_event(worker_t *worker, uint32_t index, uint32_t clock);
+bool log_completed_flight(worker_t *worker, uint32_t index);
+void release_waiting_flights(worker_t *worker, plane_t *plane);
+void activate_runway(worker_t *worker, airport_t *airport);
+void serve_runways(worker_t *worker);
+bool collect_completed_flights(simulation_param_t *sim_param);
+uint32_t next_simulation_clock(simulation_param_t *sim_param);
+bool produce_simulation_results(simulation_param_t *sim_param);
+void start_workers(simulation_param_t *sim_param);
+void stop_workers(simulation_param_t *sim_param);
+void* airport_worker(void *arg);
+
+#endif //ATSIM_SIMULATION_H
@@ -0,0 +1,26 @@
+/*
+ * File: sort.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declaration of the sort used to order the
+ *      simulation's flights by a packed integer key.
+ *
+ */
+
+#ifndef ATSIM_SORT_H
+#define ATSIM_SORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Keys are sorted a byte at a time, least significant byte first.
+ */
+#define SORT_RADIX_BITS     8u
+#define SORT_RADIX_SIZE     (1u << SORT_RADIX_BITS)
+#define SORT_KEY_DIGITS     (sizeof(uint64_t) * 8u / SORT_RADIX_BITS)
+
+bool sort_permutation(const uint64_t *keys, uint32_t *order, uint32_t count);
+
+#endif //ATSIM_SORT_H
@@ -0,0 +1,114 @@
+/*
+ * File: stats.h
+ * Author: Manuel Burnay
+ * Date: May 20, 2019
+ * Purpose:
+ *      This file contains the declarations and definitions of the
+ *      structures and functions used to time the phases of a simulation
+ *      and count what goes on in it, when asked to.
+ *
+ */
+
+#ifndef ATSIM_STATS_H
+#define ATSIM_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "atsim_definitions.h"
+
+#define STATS_CACHE_LINE    64
+#define STATS_FLIGHT_STATES (COMPLETE + 1)
+
+typedef enum {
+    STATS_PARSE,
+    STATS_SORT,
+    STATS_SETUP,
+    STATS_TICKS,            // Updating flights and serving runways,
+                            // barriers included
+    STATS_RESULTS,          // Sorting and writing the tick's results
+    STATS_FINISH,           // Stopping the workers and the final flush
+    STATS_PHASES
+} stats_phase_t;
+
+/*
+ * Each worker only writes its own entry, which sits on cache lines of its
+ * own so the workers don't contend over them. What the workers count of
+ * their flights is added up into the simulation's totals once it's over.
+ */
+typedef struct WorkerStats {
+    _Alignas(STATS_CACHE_LINE) uint64_t wait_ns;    // Waiting on barriers
+    uint64_t    busy_ns;    // Updating flights and serving runways
+    uint64_t    airports;   // Runways served
+    uint64_t    transitions[STATS_FLIGHT_STATES];
+    uint64_t    events_popped;
+} worker_stats_t;
+
+/*
+ * Everything is only counted while the simulation has stats to count into,
+ * so simulations without them only ever check for a NULL pointer.
+ * Events pushed aren't counted as they're pushed, as every one of them is
+ * either popped or still queued once the simulation is over.
+ */
+typedef struct Stats {
+    uint64_t        phase_ns[STATS_PHASES];
+    uint64_t        total_ns;
+    uint64_t        ticks;
+    uint64_t        transitions[STATS_FLIGHT_STATES];   // Into each state
+    uint64_t        events_popped;
+    uint64_t        events_left;
+    uint64_t        results;
+    uint32_t        flights;
+    uint16_t        workers;
+    worker_stats_t  worker[WORKER_MAX_COUNT];
+} stats_t;
+
+/**
+ * @brief   Reads the monotonic clock.
+ * @return  uint64_t
+ *          -- Nanoseconds since an arbitrary point in time.
+ */
+static inline uint64_t stats_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief   Adds the time since a mark to a total, and moves the mark to now.
+ * @param   [in, out] total: uint64_t*
+ *                           -- Total the elapsed nanoseconds are added to.
+ * @param   [in, out] mark: uint64_t*
+ *                          -- Point in time the lap started at.
+ */
+static inline void stats_lap(uint64_t *total, uint64_t *mark)
+{
+    uint64_t now = stats_now();
+
+    *total += now - *mark;
+    *mark = now;
+}
+
+/**
+ * @brief   Ends a lap of a phase, if there are stats to count it into.
+ * @param   [in, out] stats: stats_t*
+ *                           -- Pointer to the stats of a simulation, or NULL.
+ * @param   [in] phase: stats_phase_t
+ *                      -- Phase the lap was spent in.
+ * @param   [in, out] mark: uint64_t*
+ *                          -- Point in time the lap started at.
+ */
+static inline void stats_phase(stats_t *stats, stats_phase_t phase,
+                               uint64_t *mark)
+{
+    if (stats != NULL) {
+        stats_lap(&stats->phase_ns[phase], mark);
+    }
+}
+
+bool write_stats(const stats_t *stats, const char *path);
+
+#endif //ATSIM_STATS_H
@@ -7,19 +7,31 @@
  */
 
 #include "airport.h"
+#include "metrics.h"
 
 /**
  * @brief   Initializes the queues in the airport and gives a default value for
  *          the last queueing done by the airport.
  * @param   [out] airport: airport_t*
  *                         -- Pointer to an airport element to be initialized.
+ * @details Every flight goes through each of its airports' queues once at
+ *          most, so the queues are sized to the number of flights departing
+ *          from and arriving at the airport.
+ * @return  [bool]
+ *          -- True if the initialization was successfully completed,
+ *          False if either of the airport's queues couldn't be allocated.
  */
 bool init_airport(airport_t *airport)
 {
     airport->last_queue_type = DEPARTURE;
+    airport->runway_flight = FLIGHT_NONE;
+    airport->runway_active = false;
+    airport->metrics = NULL;
     return (
-            init_queue(&airport->arrivals_queue) == 0 &&
-            init_queue(&airport->departures_queue) == 0
+            init_queue(&airport->arrivals_queue,
+                       airport->arrival_count) == 0 &&
+            init_queue(&airport->departures_queue,
+                       airport->departure_count) == 0
     );
 }
 
@@ -28,16 +40,14 @@ bool init_airport(airport_t *airport)
  * @param   [out] airport: airport_t*
  *                         -- Pointer to an airport element to be deinitialized.
  * @return  [bool]
- *          -- True if the deinitialization was successfully completed,
- *          False if mutex destroy calls for either of the airport's queues
- *          failed.
+ *          -- Always True, as releasing the airport's queues can't fail.
  */
 bool deinit_airport(airport_t *airport)
 {
-    return (
-            pthread_mutex_destroy(&airport->arrivals_queue.mutex) == 0 &&
-            pthread_mutex_destroy(&airport->departures_queue.mutex) == 0
-    );
+    deinit_queue(&airport->arrivals_queue);
+    deinit_queue(&airport->departures_queue);
+    airport->runway_flight = FLIGHT_NONE;
+    return true;
 }
 
 /**
@@ -46,10 +56,10 @@ bool deinit_airport(airport_t *airport)
  * @param [out] airport: airport_t *
  *                       -- Pointer to an airport element
  *                          with the departure queue.
- * @param [in] flight: flight_t *
- *                     -- Pointer to the flight element to be queued.
+ * @param [in] flight: uint32_t
+ *                     -- Index of the flight to be queued.
  */
-void queue_departure(airport_t *airport, flight_t *flight)
+void queue_departure(airport_t *airport, uint32_t flight)
 {
     enqueue(&airport->departures_queue, flight);
 }
@@ -60,10 +70,10 @@ void queue_departure(airport_t *airport, flight_t *flight)
  * @param   [out] airport: airport_t *
  *                         -- Pointer to an airport element
  *                            with the arrival queue.
- * @param   [in] flight: flight_t *
- *                       -- Pointer to the flight element to be queued.
+ * @param   [in] flight: uint32_t
+ *                       -- Index of the flight to be queued.
  */
-void queue_arrival(airport_t *airport, flight_t *flight)
+void queue_arrival(airport_t *airport, uint32_t flight)
 {
     enqueue(&airport->arrivals_queue, flight);
 }
@@ -72,14 +82,21 @@ void queue_arrival(airport_t *airport, flight_t *flight)
  * @brief   Manages the runway of an airport.
  * @param   [in, out] airport: airport_t *
  *                             -- Pointer to an airport element to be managed.
- * @param   [in] sim_clock: uint16_t
+ * @param   [in, out] flights: flight_t *
+ *                             -- The flight store the queues index into.
+ * @param   [in] sim_clock: uint32_t
  *                          -- Current simulation clock tick.
  * @details This the queueing management system of the airport queues.
  *          It'll pick a flight to enter the runway (i.e. progress /
  *          move to the next state) based on currently queued flights and the
  *          last queueing type made by the airport.
+ *          The flight that used the runway (or FLIGHT_NONE) is kept in the
+ *          airport so its next event can be scheduled once the tick is over,
+ *          which is also when the plane of a flight that took off is marked
+ *          as being in the air.
+ *          The use is recorded into the airport's metrics, if it has any.
  */
-void manage_runway(airport_t *airport, uint16_t sim_clock)
+void manage_runway(airport_t *airport, flight_t *flights, uint32_t sim_clock)
 {
     // Grouping the two queues temporarily to an array allows the queueing
     // of flights to be done with less flow control operations.
@@ -89,26 +106,27 @@ void manage_runway(airport_t *airport, uint16_t sim_clock)
     };
 
     queue_types_t CurrentQueue = NEXT_QUEUE_TYPE(airport->last_queue_type);
-    flight_t * frontFlight = NULL;
 
     // Making this into a loop would be just as code and processing heavy.
-    if (size(queues[CurrentQueue]) != EMPTY_QUEUE) {
-        frontFlight = peek(queues[CurrentQueue]);
-        dequeue(queues[CurrentQueue]);
-    }
-    else {
+    uint32_t frontIndex = try_pop(queues[CurrentQueue]);
+
+    if (frontIndex == FLIGHT_NONE) {
         CurrentQueue = NEXT_QUEUE_TYPE(CurrentQueue);
-        if (size(queues[CurrentQueue]) != EMPTY_QUEUE) {
-            frontFlight = peek(queues[CurrentQueue]);
-            dequeue(queues[CurrentQueue]);
-        }
+        frontIndex = try_pop(queues[CurrentQueue]);
     }
 
     // If a flight to be queued was found.
-    if (frontFlight != NULL) {
+    if (frontIndex != FLIGHT_NONE) {
+        flight_t *frontFlight = &flights[frontIndex];
+
+        if (airport->metrics != NULL) {
+            record_runway_use(airport->metrics, queues, CurrentQueue,
+                              CurrentQueue != airport->last_queue_type,
+                              frontFlight, sim_clock);
+        }
+
         if (frontFlight->state == WAIT_TO_TAKEOFF) {
             frontFlight->state = EN_ROUTE;
-            frontFlight->plane->airport = PLANE_ON_AIR;
             frontFlight->time.departure = sim_clock;
         }
         else if (frontFlight->state == WAIT_TO_LAND) {
@@ -118,18 +136,27 @@ void manage_runway(airport_t *airport, uint16_t sim_clock)
 
         airport->last_queue_type = CurrentQueue;
     }
+
+    airport->runway_flight = frontIndex;
 }
 
 /**
  * @brief   Updates the flight's progression in the simulation.
  * @param   [in, out] flight: flight_t *
  *                            -- Pointer to the flight element to be updated.
- * @param   [in] sim_clock: uint16_t
+ * @param   [in] planes: const arena_t *
+ *                       -- The plane store the flight's plane is in.
+ * @param   [in] sim_clock: uint32_t
  *                          --  Current simulation clock tick.
+ * @details The flight's plane is only looked up when the flight is standing
+ *          by or landing, as no other state needs it.
+ *          Flights that move into the waiting states are queued at their
+ *          airport by the simulation, once their update is done.
  * @return  bool
  *          -- True if flight still requires to be updated, False if not.
  */
-bool update_flight(flight_t *flight, uint16_t sim_clock)
+bool update_flight(flight_t *flight, const arena_t *planes,
+                   uint32_t sim_clock)
 {
     bool retval = true;
 
@@ -145,7 +172,8 @@ bool update_flight(flight_t *flight, uint16_t sim_clock)
          */
         case STAND_BY: {
             if (flight->time.scheduled <= sim_clock) {
-                if (plane_ready(flight)) {
+                if (plane_ready(flight, arena_at(planes, flight->plane),
+                                sim_clock)) {
                     flight->state = DEPARTURE_TAXI;
                     flight->time.departure = sim_clock;
                 }
@@ -156,15 +184,14 @@ bool update_flight(flight_t *flight, uint16_t sim_clock)
          * DEPARTURE_TAXI state
          * The flight's progression will stall here while the departure taxi
          * procedure period hasn't elapsed.
-         * When the period has elapsed, the flight will queue itself into its
+         * When the period has elapsed, the flight will be queued into its
          * origin airport's departure queue.
          *
          * Next State: WAIT_TO_TAKEOFF
          * It will transition once the the taxi procedure period has elapsed.
          */
         case DEPARTURE_TAXI: {
-            if ((flight->time.departure + TAXI_DURATION) == sim_clock) {
-                queue_departure(flight->origin, flight);
+            if ((flight->time.departure + flight->taxi_out) == sim_clock) {
                 flight->state = WAIT_TO_TAKEOFF;
             }
         } break;
@@ -186,7 +213,7 @@ bool update_flight(flight_t *flight, uint16_t sim_clock)
          * EN_ROUTE state
          * The flight progression remains here while the flight duration period
          * hasn't elapsed.
-         * When the period has elapsed, the flight will queue itself into its
+         * When the period has elapsed, the flight will be queued into its
          * destination airport's arrival queue.
          *
          * Next State: WAIT_TO_LAND
@@ -194,7 +221,6 @@ bool update_flight(flight_t *flight, uint16_t sim_clock)
          */
         case EN_ROUTE: {
             if ((flight->time.departure + flight->time.flight) == sim_clock) {
-                queue_arrival(flight->destination, flight);
                 flight->state = WAIT_TO_LAND;
             }
         } break;
@@ -223,12 +249,14 @@ bool update_flight(flight_t *flight, uint16_t sim_clock)
          * It will transition once the the taxi procedure period has elapsed.
          */
         case ARRIVAL_TAXI: {
-            if ((flight->time.arrival + TAXI_DURATION) == sim_clock) {
+            if ((flight->time.arrival + flight->taxi_in) == sim_clock) {
+                plane_t *plane = arena_at(planes, flight->plane);
+
                 flight->time.arrival = sim_clock;
                 flight->state = COMPLETE;
 
-                flight->plane->airport = flight->destination;
-                flight->plane->groom = PLANE_GROOM_DURATION;
+                plane->airport = flight->destination;
+                plane->ready_at = sim_clock + flight->groom;
             }
         } break;
 
@@ -245,60 +273,94 @@ bool update_flight(flight_t *flight, uint16_t sim_clock)
     return retval;
 }
 
+/**
+ * @brief   Finds the clock tick at which a flight next requires an update.
+ * @param   [in] flight: flight_t *
+ *                       -- Pointer to a flight that just changed state.
+ * @details Flights waiting on a runway are moved along by their airport,
+ *          so they have no event of their own, and completed flights are
+ *          never updated again.
+ *          A flight standing by is due at its scheduled time; past that
+ *          it's waiting on its plane.
+ *          A flight time too long for its landing to fit in a clock never
+ *          raises an event, as the flight could never land within any
+ *          horizon anyway.
+ * @return  uint32_t
+ *          -- Clock tick of the flight's next event, or NO_EVENT if there
+ *             is none.
+ */
+uint32_t next_flight_event(flight_t *flight)
+{
+    uint32_t clock = NO_EVENT;
+
+    switch (flight->state) {
+        case STAND_BY: {
+            clock = flight->time.scheduled;
+        } break;
+
+        case DEPARTURE_TAXI: {
+            clock = flight->time.departure + flight->taxi_out;
+        } break;
+
+        case EN_ROUTE: {
+            // A flight with no duration is never caught by the landing check,
+            // so it shouldn't raise an event either.
+            if (flight->time.flight > 0 &&
+                flight->time.flight < NO_EVENT - flight->time.departure) {
+                clock = flight->time.departure + flight->time.flight;
+            }
+        } break;
+
+        case ARRIVAL_TAXI: {
+            clock = flight->time.arrival + flight->taxi_in;
+        } break;
+
+        case WAIT_TO_TAKEOFF:
+        case WAIT_TO_LAND:
+        case COMPLETE:
+            break;
+    }
+
+    return clock;
+}
+
 /**
  * @brief   Checks if the plane is ready to be assigned to a flight.
  * @param   [in] flight: flight_t*
  *          -- Pointer to the flight that is checking for its plane to be ready.
+ * @param   [in] plane: plane_t*
+ *          -- Pointer to the flight's plane.
+ * @param   [in] sim_clock: uint32_t
+ *          -- Current simulation clock tick.
  * @details When a flight becomes 'En Route', the plane no longer has an airport
  *          assigned to it, which is how it's determined whether or not a plane
  *          is 'busy' with another flight.
+ *          A plane that landed is only ready once the clock reaches the tick
+ *          its grooming is done at.
  * @return  bool
  *          -- True if the plane is ready to be assigned,
  *             False if not.
  */
-bool plane_ready(flight_t *flight)
-{
-    plane_t *plane = flight->plane;
-    return (plane->airport == flight->origin && plane->groom == 0);
-}
-
-/**
- * @brief   Outputs the flight log once the flight has finished it's progression.
- * @param   [in] flight: flight_t *
- *                       -- Pointer to the flight element to be updated.
- * @param   [in] sim_clock: uint16_t
- *                          -- Current simulation clock tick.
- */
-void output_flight_log(flight_t *flight)
+bool plane_ready(flight_t *flight, plane_t *plane, uint32_t sim_clock)
 {
-    atsim_time_t CompletionTime, ScheduleTime;
-    uint16_t delay;
-
-    CompletionTime = sim_ClockToTime(flight->time.arrival);
-    ScheduleTime = sim_ClockToTime(flight->time.scheduled);
-    delay = flight->time.arrival - flight->time.scheduled
-            - flight->time.flight - 2*TAXI_DURATION;
-
-    printf("[%02d:%02d] %s %d from %s to %s, departed %02d:%02d, delay %d.\n",
-           CompletionTime.hour, CompletionTime.minute, flight->carrier,
-           flight->number, flight->origin->code, flight->destination->code,
-           ScheduleTime.hour, ScheduleTime.minute, delay);
+    return (plane->airport == flight->origin && plane->ready_at <= sim_clock);
 }
 
 /**
  * @brief   Converts the simulation clock into simulation time.
- * @param   [in] clock: uint16_t
+ * @param   [in] clock: uint32_t
  *                      -- Simulation clock value.
  * @details To simplify the simulation's logic, the simulation times inside each
  *          flight are converted into a value that can be incremented easily
  *          without requiring overflow checking.
  *          This function then converts the simulation clock into its equivalent
- *          hour and minute time.
+ *          hour and minute time. The day is left at zero, so the hours keep
+ *          counting past midnight, as they do in a single day simulation.
  * @return  atsim_time_t
  *          -- struct with the equivalent hour and minute
  *             to the simulation clock.
  */
-atsim_time_t sim_ClockToTime(uint16_t clock)
+atsim_time_t sim_ClockToTime(uint32_t clock)
 {
     return (atsim_time_t) {.hour = clock / 60, .minute = clock % 60};
 }
@@ -317,5 +379,5 @@ atsim_time_t sim_ClockToTime(uint16_t clock)
  */
 uint32_t sim_TimeToClock(atsim_time_t time)
 {
-    return ((time.hour * 60) + time.minute);
+    return ((time.day * MINUTES_PER_DAY) + (time.hour * 60) + time.minute);
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+/**
+ * @file    arena.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that initialize
+ *          and manage the arenas used to store the simulation's elements.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+/**
+ * @brief   Initializes an arena.
+ * @param   [out] arena: arena_t*
+ *                       -- Pointer to an arena data type.
+ * @param   [in] element_size: uint32_t
+ *                             -- Size of the elements stored in the arena.
+ * @param   [in] capacity_hint: uint32_t
+ *                              -- Number of elements the arena is expected to
+ *                                 hold, used to size its chunks.
+ * @details No memory is taken until the first element is added.
+ * @return  bool
+ *          -- True if the arena was initialized, False if the element size
+ *             is invalid.
+ */
+bool init_arena(arena_t *arena, uint32_t element_size, uint32_t capacity_hint)
+{
+    uint32_t shift = ARENA_CHUNK_SHIFT_MIN;
+
+    while (shift < ARENA_CHUNK_SHIFT_MAX && (1u << shift) < capacity_hint) {
+        shift++;
+    }
+
+    arena->chunks         = NULL;
+    arena->chunk_count    = 0;
+    arena->chunk_capacity = 0;
+    arena->chunk_shift    = shift;
+    arena->element_size   = element_size;
+    arena->count          = 0;
+
+    return (element_size > 0);
+}
+
+/**
+ * @brief   Deinitializes an arena, releasing every chunk.
+ * @param   [out] arena: arena_t*
+ *                       -- Pointer to an arena data type.
+ */
+void deinit_arena(arena_t *arena)
+{
+    for (uint32_t i = 0; i < arena->chunk_count; i++) {
+        free(arena->chunks[i]);
+    }
+
+    free(arena->chunks);
+    arena->chunks         = NULL;
+    arena->chunk_count    = 0;
+    arena->chunk_capacity = 0;
+    arena->count          = 0;
+}
+
+/**
+ * @brief   Empties an arena, keeping its chunks for the elements added next.
+ * @param   [out] arena: arena_t*
+ *                       -- Pointer to an arena data type.
+ * @details The elements that were in use are zeroed, as elements added to the
+ *          arena always start out zeroed.
+ */
+void arena_reset(arena_t *arena)
+{
+    size_t chunk_size = ((size_t)1u << arena->chunk_shift) *
+                        arena->element_size;
+    size_t used = (size_t)arena->count * arena->element_size;
+
+    for (uint32_t i = 0; i < arena->chunk_count && used > 0; i++) {
+        size_t length = (used < chunk_size) ? used : chunk_size;
+
+        memset(arena->chunks[i], 0, length);
+        used -= length;
+    }
+
+    arena->count = 0;
+}
+
+/**
+ * @brief   Grows an arena so it holds at least a given number of elements.
+ * @param   [in, out] arena: arena_t*
+ *                           -- Pointer to an arena data type.
+ * @param   [in] count: uint32_t
+ *                      -- Number of elements the arena has to hold.
+ * @details Elements added to the arena are zeroed. Only the list of chunks
+ *          is ever reallocated, never the chunks themselves.
+ * @return  bool
+ *          -- True if the arena holds the elements, False if it ran out of
+ *             memory.
+ */
+bool arena_grow(arena_t *arena, uint32_t count)
+{
+    uint32_t chunks = (uint32_t)(((uint64_t)count + (1u << arena->chunk_shift)
+                                  - 1u) >> arena->chunk_shift);
+
+    if (chunks > arena->chunk_capacity) {
+        uint32_t capacity = (arena->chunk_capacity > 0) ?
+                arena->chunk_capacity : 1u;
+
+        while (capacity < chunks) {
+            capacity *= 2u;
+        }
+
+        uint8_t **list = realloc(arena->chunks, capacity * sizeof(uint8_t *));
+
+        if (list == NULL) {
+            return false;
+        }
+
+        arena->chunks = list;
+        arena->chunk_capacity = capacity;
+    }
+
+    while (arena->chunk_count < chunks) {
+        uint8_t *chunk = calloc((size_t)1u << arena->chunk_shift,
+                                arena->element_size);
+
+        if (chunk == NULL) {
+            return false;
+        }
+
+        arena->chunks[arena->chunk_count++] = chunk;
+    }
+
+    if (count > arena->count) {
+        arena->count = count;
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Adds an element to the end of an arena.
+ * @param   [in, out] arena: arena_t*
+ *                           -- Pointer to an arena data type.
+ * @return  void*
+ *          -- Pointer to the new zeroed element, or NULL if the arena
+ *             ran out of memory.
+ */
+void* arena_push(arena_t *arena)
+{
+    if (arena->count == UINT32_MAX || !arena_grow(arena, arena->count + 1)) {
+        return NULL;
+    }
+
+    return arena_at(arena, arena->count - 1);
+}
@@ -11,335 +11,412 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/errno.h>
 #include <stdint.h>
+#include <getopt.h>
+#include <unistd.h>
 
 #include "atsim_definitions.h"
+#include "batch.h"
+#include "metrics.h"
+#include "montecarlo.h"
+#include "schedule.h"
+#include "simulation.h"
+#include "stats.h"
 
-const char IN_END[] = "end";
-
-simulation_param_t sim;
-
-airport_t* find_airport(simulation_param_t *sim_param, const char *code);
-void configure_simulation_data(simulation_param_t *sim_param, const char *data);
-void sort_flights(flight_t *flight, uint16_t flight_count);
-void produce_simulation_results(simulation_param_t *sim_param);
-void* airport_thread(void *arg);
-
-/* Notes on threading the program:
- * Unfortunately my solution doesn't easily lend itself to be multi-threaded
- * as it stands.
- * The way the system is designed it relies on the flights being updated
- * sequentially and place on the airport's queue already in order.
- * In order to be able to thread the flight update, a priority queue with mutex
- * locks would have to be implemented to replace my existing queue,
- * and unfortunately I did not have the time to implement it before the
- * assignment's due date.
- */
+bool parse_arguments(simulation_param_t *sim_param, int argc, char **argv);
 
 int main(int argc, char ** argv)
 {
+    simulation_param_t sim;
+
     // Initialize the simulation parameters.
-    sim.airport_count = 0;
-    sim.flight_count  = 0,
-    sim.clock         = UINT16_MAX;
-    sim.state         = READ_FLIGHT_INFO;
-    sim.complete      = false;
-    sim.thread_done   = false;
-
-    char flight_data[FLIGHT_DATA_MAX_SIZE];
-
-    while (!sim.complete) {
-        switch (sim.state) {
-            /*
-             * READ_FLIGHT_INFO state
-             *
-             * In here, the system will process input from the console.
-             * Next state is SIMULATE. It'll transition once the system captures
-             * the IN_END command from console, which tells the system that
-             * there are no more flight inputs and to start simulating.
-             */
-            case READ_FLIGHT_INFO: {
-                fgets(flight_data, FLIGHT_DATA_MAX_SIZE, stdin);
-
-                // Check if the end of the console input has been received
-                if (!memcmp(flight_data, IN_END, sizeof(IN_END)-1)) {
-                    sort_flights(sim.flights, sim.flight_count);
-
-                    pthread_barrier_init(
-                            &sim.airport_start_sync,
-                            NULL,
-                            (sim.airport_count+1)
-                    );
-
-                    pthread_barrier_init(
-                            &sim.airport_end_sync,
-                            NULL,
-                            (sim.airport_count+1)
-                    );
-
-                    for (int i = 0; i < sim.airport_count; i++) {
-                        init_airport(&sim.airports[i]);
-                        pthread_create(
-                                &sim.airport_threads[i],
-                                NULL,
-                                airport_thread,
-                                &sim.airports[i]
-                        );
-                    }
+    sim.flight_count    = 0,
+    sim.horizon         = SIMULATION_DEFAULT_DAYS * MINUTES_PER_DAY;
+    sim.stream          = false;
+    sim.schedule_path   = NULL;
+    sim.compile_path    = NULL;
+    sim.checkpoint_path = NULL;
+    sim.checkpoint_at   = NO_EVENT;
+    sim.restore_path    = NULL;
+    sim.batch_paths     = NULL;
+    sim.batch_count     = 0;
+    sim.replicates      = 0;
+    sim.spread          = MONTE_CARLO_DEFAULT_SPREAD;
+    sim.seed            = MONTE_CARLO_DEFAULT_SEED;
+    sim.completions     = NULL;
+    sim.stats           = NULL;
+    sim.stats_path      = NULL;
+    sim.runway_report   = false;
+    sim.runway_report_path = NULL;
+
+    if (!parse_arguments(&sim, argc, argv)) {
+        return EXIT_FAILURE;
+    }
+
+    if (sim.batch_paths != NULL) {
+        return run_batch(&sim) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (!init_stores(&sim, sim.store_hints[0], sim.store_hints[1],
+                     sim.store_hints[2]) ||
+        !init_output(&sim.output, STDOUT_FILENO, OUTPUT_BUFFER_SIZE,
+                     sim.horizon > MINUTES_PER_DAY)) {
+        fprintf(stderr, "atsim: out of memory\n");
+        free(sim.stats);
+        return EXIT_FAILURE;
+    }
+
+    bool success = (sim.replicates > 0) ?
+            run_monte_carlo(&sim, STDIN_FILENO) :
+            run_simulation(&sim, STDIN_FILENO);
+
+    success = deinit_output(&sim.output) && success;
+
+    if (sim.runway_report) {
+        success = write_runway_report(&sim, sim.runway_report_path) &&
+                  success;
+    }
 
-                    sim.state = SIMULATE;
+    deinit_stores(&sim);
+
+    if (sim.stats != NULL) {
+        success = write_stats(sim.stats, sim.stats_path) && success;
+        free(sim.stats);
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief   Configures the simulation parameters based on the command line.
+ * @param   [out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the worker count and the run options of the simulation.
+ * @param   [in] argc: int
+ *          -- Number of command line arguments.
+ * @param   [in] argv: char**
+ *          -- Command line arguments.
+ * @details Supported options:
+ *          -j, --threads N   Number of airport workers, or of schedules run
+ *                            at once in a batch (default: one per online
+ *                            processor).
+ *          --flights N       Number of flights to size the stores for.
+ *          --airports N      Number of airports to size the stores for.
+ *          --planes N        Number of planes to size the stores for.
+ *          --stream          Write each minute's results out as soon as
+ *                            the minute is over.
+ *          --days N          Number of days to simulate (default: 1). Times
+ *                            are written as D:HH:MM when it's over 1.
+ *          --schedule-bin F  Load the schedule from the compiled schedule F
+ *                            instead of reading it from the console.
+ *          --compile F       Compile the schedule to F instead of simulating.
+ *          --checkpoint F    Save the state of the simulation to F once the
+ *          --checkpoint-at T clock reaches T (HH:MM or D:HH:MM).
+ *          --restore F       Resume the simulation from the checkpoint F,
+ *                            taken from the same schedule.
+ *          --batch F...      Simulate each of the schedules F instead of
+ *                            the one on the console, writing the results of
+ *                            each to F.out.
+ *          --replicates N    Run N replicates of the schedule with perturbed
+ *                            durations and output the percentiles of their
+ *                            delays instead of the results.
+ *          --seed S          Seed of the replicates' perturbations.
+ *          --spread P        Spread of the perturbed durations, in percent
+ *                            (default: 10).
+ *          --stats[=F]       Write the time spent in each phase of the
+ *                            simulation and its counters to F as JSON
+ *                            (default: standard error).
+ *          --runway-report[=F]
+ *                            Write the use of each airport's runway and the
+ *                            depths of its queues to F as CSV (default:
+ *                            standard error).
+ *          The stores grow past their hints as needed, the hints only save
+ *          them from growing one step at a time on large inputs.
+ * @return  bool
+ *          -- True if the arguments were valid, False if not.
+ */
+bool parse_arguments(simulation_param_t *sim_param, int argc, char **argv)
+{
+    enum {
+        OPT_FLIGHTS = 256,
+        OPT_AIRPORTS,
+        OPT_PLANES,
+        OPT_STREAM,
+        OPT_DAYS,
+        OPT_SCHEDULE_BIN,
+        OPT_COMPILE,
+        OPT_CHECKPOINT,
+        OPT_CHECKPOINT_AT,
+        OPT_RESTORE,
+        OPT_BATCH,
+        OPT_REPLICATES,
+        OPT_SEED,
+        OPT_SPREAD,
+        OPT_STATS,
+        OPT_RUNWAY_REPORT
+    };
+
+    static const struct option options[] = {
+            {"threads",       required_argument, NULL, 'j'},
+            {"flights",       required_argument, NULL, OPT_FLIGHTS},
+            {"airports",      required_argument, NULL, OPT_AIRPORTS},
+            {"planes",        required_argument, NULL, OPT_PLANES},
+            {"stream",        no_argument,       NULL, OPT_STREAM},
+            {"days",          required_argument, NULL, OPT_DAYS},
+            {"schedule-bin",  required_argument, NULL, OPT_SCHEDULE_BIN},
+            {"compile",       required_argument, NULL, OPT_COMPILE},
+            {"checkpoint",    required_argument, NULL, OPT_CHECKPOINT},
+            {"checkpoint-at", required_argument, NULL, OPT_CHECKPOINT_AT},
+            {"restore",       required_argument, NULL, OPT_RESTORE},
+            {"batch",         no_argument,       NULL, OPT_BATCH},
+            {"replicates",    required_argument, NULL, OPT_REPLICATES},
+            {"seed",          required_argument, NULL, OPT_SEED},
+            {"spread",        required_argument, NULL, OPT_SPREAD},
+            {"stats",         optional_argument, NULL, OPT_STATS},
+            {"runway-report", optional_argument, NULL, OPT_RUNWAY_REPORT},
+            {NULL,            0,                 NULL, 0}
+    };
+
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long hints[3] = {
+            FLIGHT_CAPACITY_HINT, AIRPORT_CAPACITY_HINT, PLANE_CAPACITY_HINT
+    };
+    bool batch = false;
+    char *end;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "j:", options, NULL)) != -1) {
+        switch (opt) {
+            case 'j': {
+                threads = strtol(optarg, &end, 10);
+
+                if (*end != '\0' || threads < 1) {
+                    fprintf(stderr, "%s: invalid thread count '%s'\n",
+                            argv[0], optarg);
+                    return false;
                 }
-                // Check to see if the input is at least the size of the
-                // smallest possible size for a flight data input
-                else if (strlen(flight_data) > FLIGHT_DATA_MIN_SIZE) {
-                    configure_simulation_data(&sim, flight_data);
+            } break;
+
+            case OPT_FLIGHTS:
+            case OPT_AIRPORTS:
+            case OPT_PLANES: {
+                unsigned long hint = strtoul(optarg, &end, 10);
+
+                if (*end != '\0' || hint > UINT32_MAX) {
+                    fprintf(stderr, "%s: invalid capacity '%s'\n",
+                            argv[0], optarg);
+                    return false;
                 }
+
+                hints[opt - OPT_FLIGHTS] = hint;
+            } break;
+
+            case OPT_STREAM: {
+                sim_param->stream = true;
+            } break;
+
+            case OPT_DAYS: {
+                unsigned long days = strtoul(optarg, &end, 10);
+
+                if (*end != '\0' || days < 1 || days > SIMULATION_MAX_DAYS) {
+                    fprintf(stderr, "%s: invalid day count '%s'\n",
+                            argv[0], optarg);
+                    return false;
+                }
+
+                sim_param->horizon = days * MINUTES_PER_DAY;
+            } break;
+
+            case OPT_SCHEDULE_BIN: {
+                sim_param->schedule_path = optarg;
+            } break;
+
+            case OPT_COMPILE: {
+                sim_param->compile_path = optarg;
             } break;
 
-            /*
-             * SIMULATE state
-             *
-             * In here, the system will simulate the airport scheduling system.
-             * Next state is SIMULATION_COMPLETE. It'll transition once the
-             * flights in the system are complete.
-             */
-            case SIMULATE: {
-                // If a single flight still requires to update, the simulation's
-                // state goes back to SIMULATE
-                sim.state = SIMULATION_COMPLETE;
-
-                for (int i = 0; i < PLANE_MAX_COUNT; i++) {
-                    if (sim.planes[i].groom > 0) {
-                        sim.planes[i].groom--;
+            case OPT_CHECKPOINT: {
+                sim_param->checkpoint_path = optarg;
+            } break;
+
+            case OPT_CHECKPOINT_AT: {
+                unsigned int day = 0, hour, minute;
+                char extra;
+
+                // Either HH:MM or D:HH:MM, like departure times.
+                if (sscanf(optarg, "%u:%u:%u%c", &day, &hour, &minute,
+                           &extra) != 3) {
+                    day = 0;
+
+                    if (sscanf(optarg, "%u:%u%c", &hour, &minute,
+                               &extra) != 2) {
+                        hour = HOURS_PER_DAY;
                     }
                 }
 
-                for (int i = 0; i < sim.flight_count; i++) {
-                    // Only keep simulating while there are still flights
-                    // left to update
-                    sim.state = (update_flight(&sim.flights[i], sim.clock)) ?
-                            SIMULATE : sim.state;
+                // Out of range fields would wrap into some other time.
+                if (day > SIMULATION_MAX_DAYS || hour >= HOURS_PER_DAY ||
+                    minute >= MINUTES_PER_HOUR) {
+                    fprintf(stderr, "%s: invalid checkpoint time '%s'\n",
+                            argv[0], optarg);
+                    return false;
                 }
 
-                if (sim.clock == SIMULATION_MAX_TIME) {
-                    sim.state = SIMULATION_COMPLETE;
+                sim_param->checkpoint_at = sim_TimeToClock((atsim_time_t) {
+                        .day = day, .hour = hour, .minute = minute});
+            } break;
+
+            case OPT_RESTORE: {
+                sim_param->restore_path = optarg;
+            } break;
+
+            case OPT_BATCH: {
+                batch = true;
+            } break;
+
+            case OPT_REPLICATES: {
+                unsigned long replicates = strtoul(optarg, &end, 10);
+
+                if (*end != '\0' || replicates < 1 ||
+                    replicates > UINT32_MAX) {
+                    fprintf(stderr, "%s: invalid replicate count '%s'\n",
+                            argv[0], optarg);
+                    return false;
                 }
 
-                // Here the airports begin to update themselves concurrently.
-                pthread_barrier_wait(&sim.airport_start_sync);
+                sim_param->replicates = replicates;
+            } break;
+
+            case OPT_SEED: {
+                sim_param->seed = strtoull(optarg, &end, 0);
+
+                if (*end != '\0') {
+                    fprintf(stderr, "%s: invalid seed '%s'\n",
+                            argv[0], optarg);
+                    return false;
+                }
+            } break;
 
-                sim.thread_done = (sim.state == SIMULATION_COMPLETE);
+            case OPT_SPREAD: {
+                unsigned long spread = strtoul(optarg, &end, 10);
 
-                /*
-                 * Here all airport updates are synced when they complete.
-                 * It also makes sure all airports perform a check on
-                 * sim.thread_done only after the variable has been written to.
-                 */
-                pthread_barrier_wait(&sim.airport_end_sync);
+                if (*end != '\0' || spread > MONTE_CARLO_MAX_SPREAD) {
+                    fprintf(stderr, "%s: invalid spread '%s'\n",
+                            argv[0], optarg);
+                    return false;
+                }
 
-                sim.clock++;
+                sim_param->spread = spread;
             } break;
 
-            /*
-             * SIMULATION_COMPLETE state
-             *
-             * It set the simulation complete flag, which will end the
-             * simulation in the following program loop pass.
-             */
-            case SIMULATION_COMPLETE: {
-                for (int i = 0; i < sim.airport_count; i++) {
-                    pthread_join(sim.airport_threads[i], NULL);
-                    deinit_airport(&sim.airports[i]);
+            case OPT_STATS: {
+                if (sim_param->stats == NULL) {
+                    sim_param->stats = aligned_alloc(STATS_CACHE_LINE,
+                                                     sizeof(stats_t));
+
+                    if (sim_param->stats == NULL) {
+                        fprintf(stderr, "%s: out of memory\n", argv[0]);
+                        return false;
+                    }
+
+                    memset(sim_param->stats, 0, sizeof(stats_t));
                 }
 
-                pthread_barrier_destroy(&sim.airport_start_sync);
-                pthread_barrier_destroy(&sim.airport_end_sync);
+                sim_param->stats_path = optarg;
+            } break;
+
+            case OPT_RUNWAY_REPORT: {
+                sim_param->runway_report = true;
+                sim_param->runway_report_path = optarg;
+            } break;
 
-                produce_simulation_results(&sim);
-                sim.complete = true;
-            }break;
+            default: {
+                fprintf(stderr, "usage: %s [-j threads] [--flights N] "
+                                "[--airports N] [--planes N] [--stream] "
+                                "[--days N] [--schedule-bin FILE] "
+                                "[--compile FILE] [--checkpoint FILE "
+                                "--checkpoint-at TIME] [--restore FILE] "
+                                "[--stats[=FILE]] [--runway-report[=FILE]] "
+                                "< schedule\n"
+                                "       %s --batch [-j threads] [--flights N] "
+                                "[--airports N] [--planes N] [--days N] "
+                                "FILE...\n"
+                                "       %s --replicates N [--seed S] "
+                                "[--spread PERCENT] [-j threads] [--days N] "
+                                "[--schedule-bin FILE] < schedule\n",
+                        argv[0], argv[0], argv[0]);
+                return false;
+            }
         }
     }
-    return 0;
-}
-
-/**
- * @brief   Looks for an airport with a given code, and instantiates an airport
- *          if not found.
- * @param   [in, out] sim_param: simulation_param_t*
- *          -- Pointer to simulation parameters data type.
- *          -- Uses and alters the array of airports and the current airport
- *             count in the simulation.
- * @param   [in] code: const char*
- *          -- Airport code.
- * @return  airport_t*
- *          -- pointer to airport element with corresponding code.
- */
-airport_t* find_airport(simulation_param_t *sim_param, const char *code)
-{
-    int i = 0;
-    bool airport_found = false;
 
-    while (i < sim_param->airport_count && !airport_found) {
-        airport_found = !memcmp(sim_param->airports[i].code, code, CODE_LENGTH);
-        i += !airport_found;    // only increment if airport wasn't found
+    if ((sim_param->checkpoint_path == NULL) !=
+        (sim_param->checkpoint_at == NO_EVENT)) {
+        fprintf(stderr, "%s: --checkpoint and --checkpoint-at go together\n",
+                argv[0]);
+        return false;
     }
 
-    if (i == sim_param->airport_count) {
-        memcpy(
-                sim_param->airports[sim_param->airport_count].code,
-                code,
-                CODE_STR_SIZE
-        );
-        sim_param->airport_count++;
+    // The days simulated may be given after the checkpoint time.
+    if (sim_param->checkpoint_at != NO_EVENT &&
+        sim_param->checkpoint_at > sim_param->horizon) {
+        fprintf(stderr, "%s: the checkpoint time is past the days "
+                        "simulated\n", argv[0]);
+        return false;
     }
 
-    return &sim_param->airports[i];
-}
+    // A batch only simulates the schedules it's given, and nothing else
+    // takes any.
+    if (batch != (optind < argc)) {
+        fprintf(stderr, batch ? "%s: --batch needs the schedules to run\n" :
+                                "%s: schedules are only given with --batch\n",
+                argv[0]);
+        return false;
+    }
 
-/**
- * @brief   Configures the simulation parameters based on the input received
- *          from the console.
- * @param   [in, out] sim_param: simulation_param_t*
- *          -- Pointer to simulation parameters data type.
- *          -- Uses and alters every element in the simulation
- *             parameters except state and complete flag.
- * @param   [in] data: const char*
- *          -- Data string received from console.
- */
-void configure_simulation_data(simulation_param_t *sim_param, const char *data)
-{
-    flight_t *flight = &(sim_param->flights[sim_param->flight_count]);
-    char origin_code[CODE_STR_SIZE], dest_code[CODE_STR_SIZE];
-    atsim_time_t time;
-    uint16_t plane_id;
-
-    sscanf(data, "%2s %hd %hd %3s %hhd:%hhd %hd %3s", flight->carrier,
-           &flight->number, &plane_id, origin_code, &time.hour, &time.minute,
-           &flight->time.flight, dest_code);
-
-    /*
-     * The console input isn't checked for invalid data on purpose.
-     * As this is simply a simulation of a system, it is the user's
-     * responsibility to input valid data into the program.
-     */
-
-    // The simulation time is converted into its equivalent clock value.
-    flight->time.scheduled = sim_TimeToClock(time);
-    flight->origin         = find_airport(sim_param, origin_code);
-    flight->destination    = find_airport(sim_param, dest_code);
-    flight->plane          = &sim_param->planes[plane_id];
-
-    if (sim_param->planes[plane_id].airport == NULL) {
-        sim_param->planes[plane_id].airport = flight->origin;
+    if (batch && (sim_param->schedule_path != NULL ||
+                  sim_param->compile_path != NULL ||
+                  sim_param->checkpoint_path != NULL ||
+                  sim_param->restore_path != NULL)) {
+        fprintf(stderr, "%s: --batch only runs text schedules from start to "
+                        "end\n", argv[0]);
+        return false;
     }
 
-    // Set the simulation clock to start at the first departure of the
-    // simulation, as to avoid needless loops of the program.
-    sim_param->clock = (flight->time.scheduled < sim_param->clock) ?
-                 flight->time.scheduled : sim_param->clock;
-    sim_param->flight_count++;
-}
+    if (sim_param->replicates > 0 && (batch || sim_param->stream ||
+                                      sim_param->compile_path != NULL ||
+                                      sim_param->checkpoint_path != NULL ||
+                                      sim_param->restore_path != NULL)) {
+        fprintf(stderr, "%s: --replicates only runs a schedule from start to "
+                        "end\n", argv[0]);
+        return false;
+    }
 
-/**
- * @brief   Sorts the flight elements in the simulation based on their
- *          flight number. Utilizes simple bubble sort.
- * @param   [in, out] flight: flight_t*
- *          -- Array of flight data types.
- * @param   [in] flight_count: uint16_t
- *          -- Count of flights in the simulation.
- */
-void sort_flights(flight_t *flight, uint16_t flight_count)
-{
-    flight_t temp;
-
-    for (int i = 0; i < flight_count-1; i++) {
-        for (int j = 0; j < flight_count-i-1; j++) {
-            if (flight[j].number > flight[j+1].number) {
-                temp = flight[j];
-                flight[j] = flight[j + 1];
-                flight[j + 1] = temp;
-            }
-        }
+    // The stats are those of a single simulation.
+    if (sim_param->stats != NULL && (batch || sim_param->replicates > 0)) {
+        fprintf(stderr, "%s: --stats only times a single simulation\n",
+                argv[0]);
+        return false;
     }
-}
 
-/**
- * @brief   Airport update thread function.
- * @param   [in, out] arg: [void *]
- *          -- Pointer to airport_t element that the thread will update.
- * @return  [void *]
- *          -- Will always return NULL.
- * @details This function uses two barriers:
- *          one prevents the airports from being updated before all flights
- *          have gone through their update procedure,
- *          and the other is to prevent the main thread from updating the
- *          simulation clock before all airports have been updated.
- */
-void* airport_thread(void *arg)
-{
-    airport_t *airport = arg;
+    if (sim_param->runway_report && (batch || sim_param->replicates > 0 ||
+                                     sim_param->compile_path != NULL)) {
+        fprintf(stderr, "%s: --runway-report only reports on a single "
+                        "simulation\n", argv[0]);
+        return false;
+    }
 
-    while (!sim.thread_done ) {
-        pthread_barrier_wait(&sim.airport_start_sync);
-        manage_runway(airport, sim.clock);
-        pthread_barrier_wait(&sim.airport_end_sync);
+    if (batch) {
+        sim_param->batch_paths = &argv[optind];
+        sim_param->batch_count = argc - optind;
     }
 
-    return NULL;
-}
+    sim_param->worker_count = (threads < 1) ? 1 :
+            (threads > WORKER_MAX_COUNT) ? WORKER_MAX_COUNT : threads;
 
-/**
- * @brief   Outputs the results of the simulation.
- * @param   [in, out] sim_param: simulation_param_t*
- *          -- Pointer to the simulation parameters.
- * @details This function will re-sort of the flight elements based on
- *          their completion time, carrier code, and flight number,
- *          and afterwards output their results if the flight managed to
- *          complete during the simulation's time frame.
- */
-void produce_simulation_results(simulation_param_t *sim_param)
-{
-    flight_t temp, *flight = sim_param->flights;
-    int cmp;
-
-    /*
-     * Sort flights based on completion time.
-     * If flights have the same completion time,
-     * it'll sort them by carrier code.
-     * If flights have the same carrier code,
-     * it'll sort them by the flight number.
-     */
-    for (int i = 0; i < sim_param->flight_count-1; i++) {
-        for (int j = 0; j < sim_param->flight_count - i - 1; j++) {
-            if (flight[j].time.arrival > flight[j + 1].time.arrival) {
-                temp = flight[j];
-                flight[j] = flight[j + 1];
-                flight[j + 1] = temp;
-            }
-            else if (flight[j].time.arrival == flight[j + 1].time.arrival) {
-                cmp = memcmp(flight[j].carrier, flight[j + 1].carrier,
-                             CARRIER_ID_LENGTH);
-
-                /*
-                 * If the carrier ID is larger than the next element or
-                 * If the carrier ID is equal, but the flight number is larger
-                 */
-                if (cmp > 0 ||
-                    (cmp == 0 && flight[j].number > flight[j + 1].number)) {
-                    temp = flight[j];
-                    flight[j] = flight[j + 1];
-                    flight[j + 1] = temp;
-                }
-            }
-        }
+    for (int i = 0; i < 3; i++) {
+        sim_param->store_hints[i] = hints[i];
     }
 
-    // Output after the flight sort.
-    for (int i = 0; i < sim_param->flight_count; i++) {
-        if (flight[i].state == COMPLETE) {
-            output_flight_log(&flight[i]);
-        }
-    }
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+/**
+ * @file    barrier.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that initialize
+ *          and manage the spinning barrier used to synchronize the
+ *          simulation's threads.
+ */
+
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "barrier.h"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * @brief   Puts the calling thread to sleep while a word holds a value.
+ * @param   [in] word: _Atomic uint32_t*
+ *                     -- Word the thread sleeps on.
+ * @param   [in] value: uint32_t
+ *                      -- Value the word holds while the thread should sleep.
+ * @details The check and the sleep are done atomically by the kernel, so a
+ *          change made right before the call is never missed.
+ *          Systems without futexes simply give up the processor.
+ */
+static void sleep_on(_Atomic uint32_t *word, uint32_t value)
+{
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+    (void)word;
+    (void)value;
+    sched_yield();
+#endif
+}
+
+/**
+ * @brief   Wakes every thread sleeping on a word.
+ * @param   [in] word: _Atomic uint32_t*
+ *                     -- Word the threads sleep on.
+ */
+static void wake_all(_Atomic uint32_t *word)
+{
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+    (void)word;
+#endif
+}
+
+/**
+ * @brief   Tells the processor the calling thread is spinning.
+ */
+static inline void spin_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief   Initializes a spinning barrier.
+ * @param   [out] barrier: spin_barrier_t*
+ *                         -- Pointer to a spinning barrier data type.
+ * @param   [in] participants: uint32_t
+ *                             -- Number of threads that have to arrive at
+ *                                the barrier before any is let through.
+ * @return  int
+ *          -- 0 on success, -1 if there are no participants.
+ */
+int spin_barrier_init(spin_barrier_t *barrier, uint32_t participants)
+{
+    if (participants == 0) {
+        return -1;
+    }
+
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    barrier->participants = participants;
+    barrier->spin_limit = (processors > 0 && participants <= processors) ?
+            BARRIER_SPIN_LIMIT : 0;
+    atomic_init(&barrier->count, participants);
+    atomic_init(&barrier->sense, 0);
+    atomic_init(&barrier->sleepers, 0);
+    return 0;
+}
+
+/**
+ * @brief   Waits at a spinning barrier until every participant has arrived.
+ * @param   [in, out] barrier: spin_barrier_t*
+ *                             -- Pointer to a spinning barrier data type.
+ * @details Each thread takes note of the barrier's sense when it arrives.
+ *          The last thread to arrive resets the count for the next round and
+ *          flips the sense, which is what the other threads are waiting for.
+ *          Waiting threads spin for a bounded number of checks before they
+ *          sleep (none if the processors are oversubscribed), and the last
+ *          thread only makes the wake up system call if any of them actually
+ *          went to sleep.
+ * @return  int
+ *          -- PTHREAD_BARRIER_SERIAL_THREAD for the last thread to arrive,
+ *             0 for every other thread.
+ */
+int spin_barrier_wait(spin_barrier_t *barrier)
+{
+    uint32_t sense = atomic_load_explicit(&barrier->sense,
+                                          memory_order_relaxed);
+
+    if (atomic_fetch_sub_explicit(&barrier->count, 1,
+                                  memory_order_acq_rel) == 1) {
+        atomic_store_explicit(&barrier->count, barrier->participants,
+                              memory_order_relaxed);
+        atomic_store(&barrier->sense, sense ^ 1u);
+
+        if (atomic_load(&barrier->sleepers) > 0) {
+            wake_all(&barrier->sense);
+        }
+
+        return PTHREAD_BARRIER_SERIAL_THREAD;
+    }
+
+    for (uint32_t i = 0; i < barrier->spin_limit; i++) {
+        if (atomic_load_explicit(&barrier->sense,
+                                 memory_order_acquire) != sense) {
+            return 0;
+        }
+
+        spin_pause();
+    }
+
+    atomic_fetch_add(&barrier->sleepers, 1);
+
+    while (atomic_load(&barrier->sense) == sense) {
+        sleep_on(&barrier->sense, sense);
+    }
+
+    atomic_fetch_sub_explicit(&barrier->sleepers, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief   Deinitializes a spinning barrier.
+ * @param   [out] barrier: spin_barrier_t*
+ *                         -- Pointer to a spinning barrier data type.
+ * @return  int
+ *          -- Always 0, as the barrier holds no resources.
+ */
+int spin_barrier_destroy(spin_barrier_t *barrier)
+{
+    barrier->participants = 0;
+    return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file    batch.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that run a batch of
+ *          independent schedules on a pool of threads, each schedule with
+ *          its results written to its own file.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "schedule.h"
+#include "simulation.h"
+
+/**
+ * @brief   Runs every schedule of a batch.
+ * @param   [in] options: const simulation_param_t*
+ *          -- Pointer to the simulation parameters given on the command line.
+ *          -- Its worker count is the number of schedules run at once, and
+ *             its batch paths are the schedules to run.
+ * @details Each thread runs whole simulations, so the simulations themselves
+ *          serve their runways without workers of their own.
+ *          The calling thread takes a share of the schedules as well.
+ *          Everything is set up before any thread starts, so an out of memory
+ *          failure stops the batch before any schedule is run.
+ * @return  bool
+ *          -- True if every schedule was simulated and its results written,
+ *             False if any of them failed.
+ */
+bool run_batch(const simulation_param_t *options)
+{
+    uint32_t threads = (options->worker_count < options->batch_count) ?
+            options->worker_count : options->batch_count;
+    // Every worker_t of the simulations sits on cache lines of its own.
+    batch_worker_t *workers = aligned_alloc(WORKER_CACHE_LINE,
+                                              threads * sizeof(batch_worker_t));
+    batch_t batch = {
+            .paths = options->batch_paths,
+            .count = options->batch_count
+    };
+    uint32_t ready = 0, started = 1;
+
+    atomic_init(&batch.next, 0);
+    atomic_init(&batch.failed, 0);
+
+    for (; workers != NULL && ready < threads; ready++) {
+        simulation_param_t *sim_param = &workers[ready].sim;
+
+        *sim_param = *options;
+        sim_param->worker_count = 1;
+        workers[ready].batch = &batch;
+
+        if (!init_stores(sim_param, options->store_hints[0],
+                         options->store_hints[1], options->store_hints[2]) ||
+            !init_output(&sim_param->output, -1, OUTPUT_BUFFER_SIZE,
+                         options->horizon > MINUTES_PER_DAY)) {
+            deinit_stores(sim_param);
+            break;
+        }
+    }
+
+    if (ready < threads) {
+        fprintf(stderr, "atsim: out of memory\n");
+    }
+    else {
+        while (started < threads &&
+               pthread_create(&workers[started].thread, NULL, batch_worker,
+                              &workers[started]) == 0) {
+            started++;
+        }
+
+        batch_worker(&workers[0]);
+
+        for (uint32_t i = 1; i < started; i++) {
+            pthread_join(workers[i].thread, NULL);
+        }
+    }
+
+    for (uint32_t i = 0; i < ready; i++) {
+        deinit_output(&workers[i].sim.output);
+        deinit_stores(&workers[i].sim);
+    }
+
+    free(workers);
+    return (ready == threads && atomic_load(&batch.failed) == 0);
+}
+
+/**
+ * @brief   Batch thread function.
+ * @param   [in] arg: [void *]
+ *          -- Pointer to the batch worker the thread runs as.
+ * @return  [void *]
+ *          -- Will always return NULL.
+ * @details The thread keeps taking the next schedule of the batch until
+ *          there are none left.
+ */
+void* batch_worker(void *arg)
+{
+    batch_worker_t *worker = arg;
+    batch_t *batch = worker->batch;
+    uint32_t index;
+
+    while ((index = atomic_fetch_add(&batch->next, 1)) < batch->count) {
+        if (!run_batch_entry(&worker->sim, batch->paths[index])) {
+            atomic_fetch_add(&batch->failed, 1);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief   Runs a single schedule of a batch.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to the simulation of the thread running the schedule.
+ *          -- Its stores are emptied once the schedule has been simulated.
+ * @param   [in] path: const char*
+ *          -- Path of the schedule. Its results are written to the same
+ *             path followed by BATCH_OUTPUT_SUFFIX.
+ * @return  bool
+ *          -- True if the schedule was simulated and its results written,
+ *             False if not.
+ */
+bool run_batch_entry(simulation_param_t *sim_param, const char *path)
+{
+    size_t length = strlen(path);
+    char *output_path = malloc(length + sizeof(BATCH_OUTPUT_SUFFIX));
+    int input = -1, output = -1;
+    bool success = false;
+
+    if (output_path == NULL) {
+        fprintf(stderr, "atsim: out of memory\n");
+        return false;
+    }
+
+    memcpy(output_path, path, length);
+    memcpy(output_path + length, BATCH_OUTPUT_SUFFIX,
+           sizeof(BATCH_OUTPUT_SUFFIX));
+
+    if ((input = open(path, O_RDONLY)) < 0) {
+        fprintf(stderr, "atsim: %s: %s\n", path, strerror(errno));
+    }
+    else if ((output = open(output_path, O_WRONLY | O_CREAT | O_TRUNC,
+                            0666)) < 0) {
+        fprintf(stderr, "atsim: %s: %s\n", output_path, strerror(errno));
+    }
+    else {
+        output_redirect(&sim_param->output, output);
+
+        if (!(success = run_simulation(sim_param, input))) {
+            fprintf(stderr, "atsim: %s: the schedule couldn't be simulated\n",
+                    path);
+        }
+    }
+
+    if (output >= 0 && close(output) != 0 && success) {
+        fprintf(stderr, "atsim: %s: %s\n", output_path, strerror(errno));
+        success = false;
+    }
+
+    if (input >= 0) {
+        close(input);
+    }
+
+    reset_stores(sim_param);
+    free(output_path);
+    return success;
+}
@@ -0,0 +1,428 @@
+/**
+ * @file    checkpoint.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that save the state of a
+ *          running simulation to a checkpoint and restore it from one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkpoint.h"
+#include "file.h"
+
+#define FNV_OFFSET_BASIS    0xCBF29CE484222325ull
+#define FNV_PRIME           0x100000001B3ull
+
+/*
+ * Offset of each section from the start of the checkpoint.
+ */
+typedef struct {
+    size_t  flights;
+    size_t  planes;
+    size_t  airports;
+    size_t  queued;
+    size_t  runways;
+    size_t  events;
+    size_t  size;
+} checkpoint_layout_t;
+
+/**
+ * @brief   Works out where each section of a checkpoint sits.
+ * @param   [in] header: const checkpoint_header_t*
+ *                       -- Header of the checkpoint.
+ * @param   [out] layout: checkpoint_layout_t*
+ *                        -- Gets the offset of each section.
+ */
+static void checkpoint_layout(const checkpoint_header_t *header,
+                              checkpoint_layout_t *layout)
+{
+    size_t offset = sizeof(checkpoint_header_t);
+
+    layout->flights  = offset;
+    offset += (size_t)header->flight_count * sizeof(checkpoint_flight_t);
+    layout->planes   = offset;
+    offset += (size_t)header->plane_count * sizeof(checkpoint_plane_t);
+    layout->airports = offset;
+    offset += (size_t)header->airport_count * sizeof(checkpoint_airport_t);
+    layout->queued   = offset;
+    offset += (size_t)header->queued_count * sizeof(uint32_t);
+    layout->runways  = offset;
+    offset += (size_t)header->runway_count * sizeof(uint32_t);
+    // Padded so the event keys can be read in place from the mapped file.
+    offset  = (offset + _Alignof(sim_event_t) - 1) &
+              ~(size_t)(_Alignof(sim_event_t) - 1);
+    layout->events   = offset;
+    offset += (size_t)header->event_count * sizeof(sim_event_t);
+    layout->size     = offset;
+}
+
+/**
+ * @brief   Hashes a value into a running FNV-1a hash.
+ * @param   [in] hash: uint64_t
+ *                     -- Hash so far.
+ * @param   [in] value: uint32_t
+ *                      -- Value to hash, one byte at a time.
+ * @return  uint64_t
+ *          -- Updated hash.
+ */
+static inline uint64_t fnv_hash(uint64_t hash, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        hash = (hash ^ ((value >> (i * 8)) & 0xFFu)) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief   Fingerprints the schedule being simulated.
+ * @param   [in] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ * @details Covers every airport code and every field of every flight that
+ *          comes from the schedule, in the order the simulation keeps them.
+ * @return  uint64_t
+ *          -- Fingerprint of the schedule.
+ */
+static uint64_t schedule_fingerprint(simulation_param_t *sim_param)
+{
+    uint64_t hash = fnv_hash(FNV_OFFSET_BASIS, sim_param->planes.count);
+
+    for (uint32_t i = 0; i < sim_param->airports.count; i++) {
+        const char *code = AIRPORT(sim_param, i)->code;
+        hash = fnv_hash(hash, (uint8_t)code[0] | (uint8_t)code[1] << 8 |
+                              (uint8_t)code[2] << 16);
+    }
+
+    for (uint32_t i = 0; i < sim_param->flight_count; i++) {
+        flight_t *flight = &sim_param->flights[i];
+        flight_info_t *info = &sim_param->flight_info[i];
+
+        hash = fnv_hash(hash, (uint8_t)info->carrier[0] |
+                              (uint8_t)info->carrier[1] << 8 |
+                              (uint32_t)info->number << 16);
+        hash = fnv_hash(hash, flight->plane);
+        hash = fnv_hash(hash, flight->origin);
+        hash = fnv_hash(hash, flight->destination);
+        hash = fnv_hash(hash, flight->time.scheduled);
+        hash = fnv_hash(hash, flight->time.flight);
+    }
+
+    return hash;
+}
+
+// References to no flight or no airport are written as they are.
+_Static_assert(CHECKPOINT_NONE == FLIGHT_NONE &&
+               CHECKPOINT_NONE == AIRPORT_NONE,
+               "checkpoints keep the simulation's empty references");
+
+/**
+ * @brief   Saves the state of the simulation to a checkpoint.
+ * @param   [in] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Must be between two clock ticks, with the airport workers
+ *             waiting for the next one.
+ * @param   [in] path: const char*
+ *          -- Path of the checkpoint to write.
+ * @details The simulation resumes from the tick the clock is set to, which
+ *          hasn't been simulated yet.
+ * @return  bool
+ *          -- True if the checkpoint was written, False if not.
+ */
+bool write_checkpoint(simulation_param_t *sim_param, const char *path)
+{
+    checkpoint_header_t header = {
+            .magic         = CHECKPOINT_MAGIC,
+            .version       = CHECKPOINT_VERSION,
+            .fingerprint   = schedule_fingerprint(sim_param),
+            .clock         = sim_param->clock,
+            .flight_count  = sim_param->flight_count,
+            .airport_count = sim_param->airports.count,
+            .plane_count   = sim_param->planes.count,
+            .runway_count  = sim_param->runway_count,
+            .event_count   = sim_param->events.count
+    };
+    checkpoint_layout_t layout;
+
+    for (uint32_t i = 0; i < header.airport_count; i++) {
+        airport_t *airport = AIRPORT(sim_param, i);
+        header.queued_count += size(&airport->departures_queue) +
+                               size(&airport->arrivals_queue);
+    }
+
+    checkpoint_layout(&header, &layout);
+    uint8_t *data = calloc(1, layout.size);
+
+    if (data == NULL) {
+        fprintf(stderr, "atsim: out of memory\n");
+        return false;
+    }
+
+    checkpoint_flight_t *flights = (checkpoint_flight_t *)(data +
+                                                           layout.flights);
+    checkpoint_plane_t *planes = (checkpoint_plane_t *)(data + layout.planes);
+    checkpoint_airport_t *airports = (checkpoint_airport_t *)(data +
+                                                              layout.airports);
+    uint32_t *queued = (uint32_t *)(data + layout.queued);
+    uint32_t *runways = (uint32_t *)(data + layout.runways);
+
+    memcpy(data, &header, sizeof(header));
+
+    for (uint32_t i = 0; i < header.flight_count; i++) {
+        flight_t *flight = &sim_param->flights[i];
+
+        flights[i].departure    = flight->time.departure;
+        flights[i].arrival      = flight->time.arrival;
+        flights[i].next_waiting = sim_param->flight_info[i].next_waiting;
+        flights[i].state        = flight->state;
+    }
+
+    for (uint32_t i = 0; i < header.plane_count; i++) {
+        plane_t *plane = PLANE(sim_param, i);
+
+        planes[i].airport  = plane->airport;
+        planes[i].ready_at = plane->ready_at;
+        planes[i].waiting  = plane->waiting;
+    }
+
+    for (uint32_t i = 0; i < header.airport_count; i++) {
+        airport_t *airport = AIRPORT(sim_param, i);
+        flight_queue_t *queues[QUEUE_TYPES] = {
+                &airport->departures_queue,
+                &airport->arrivals_queue
+        };
+
+        airports[i].departures      = size(queues[DEPARTURE]);
+        airports[i].arrivals        = size(queues[ARRIVAL]);
+        airports[i].last_queue_type = airport->last_queue_type;
+        airports[i].runway_active   = airport->runway_active;
+
+        for (int type = 0; type < QUEUE_TYPES; type++) {
+            uint32_t flight;
+
+            for (uint32_t j = 0;
+                 (flight = peek_queue(queues[type], j)) != FLIGHT_NONE; j++) {
+                *queued++ = flight;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < header.runway_count; i++) {
+        runways[i] = sim_param->runway_airports[i]->id;
+    }
+
+    memcpy(data + layout.events, sim_param->events.heap,
+           (size_t)header.event_count * sizeof(sim_event_t));
+
+    bool written = write_file(path, data, layout.size);
+    free(data);
+    return written;
+}
+
+/**
+ * @brief   Checks the state of a checkpoint before any of it is restored.
+ * @param   [in] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ * @param   [in] header: const checkpoint_header_t*
+ *                       -- Header of the checkpoint.
+ * @param   [in] layout: const checkpoint_layout_t*
+ *                       -- Where each section of the checkpoint sits.
+ * @param   [in] data: const uint8_t*
+ *                     -- Start of the checkpoint.
+ * @return  const char*
+ *          -- Why the checkpoint can't be restored, or NULL if it can.
+ */
+static const char* check_checkpoint(simulation_param_t *sim_param,
+                                    const checkpoint_header_t *header,
+                                    const checkpoint_layout_t *layout,
+                                    const uint8_t *data)
+{
+    const checkpoint_flight_t *flights = (const checkpoint_flight_t *)
+            (data + layout->flights);
+    const checkpoint_plane_t *planes = (const checkpoint_plane_t *)
+            (data + layout->planes);
+    const checkpoint_airport_t *airports = (const checkpoint_airport_t *)
+            (data + layout->airports);
+    const uint32_t *queued = (const uint32_t *)(data + layout->queued);
+    const uint32_t *runways = (const uint32_t *)(data + layout->runways);
+    const sim_event_t *events = (const sim_event_t *)(data + layout->events);
+    uint64_t queued_count = 0;
+
+#define VALID_FLIGHT(index) \
+    ((index) == CHECKPOINT_NONE || (index) < header->flight_count)
+
+    for (uint32_t i = 0; i < header->flight_count; i++) {
+        if (flights[i].state > COMPLETE ||
+            !VALID_FLIGHT(flights[i].next_waiting)) {
+            return "invalid flight state";
+        }
+    }
+
+    for (uint32_t i = 0; i < header->plane_count; i++) {
+        if ((planes[i].airport != CHECKPOINT_NONE &&
+             planes[i].airport >= header->airport_count) ||
+            !VALID_FLIGHT(planes[i].waiting)) {
+            return "invalid plane state";
+        }
+    }
+
+    // Queues can't hold more than the flights going through their airport.
+    for (uint32_t i = 0; i < header->airport_count; i++) {
+        airport_t *airport = AIRPORT(sim_param, i);
+        queued_count += (uint64_t)airports[i].departures + airports[i].arrivals;
+
+        if (airports[i].last_queue_type >= QUEUE_TYPES ||
+            airports[i].departures > airport->departure_count ||
+            airports[i].arrivals > airport->arrival_count) {
+            return "invalid airport state";
+        }
+    }
+
+    if (queued_count != header->queued_count) {
+        return "invalid airport state";
+    }
+
+    for (uint32_t i = 0; i < header->queued_count; i++) {
+        if (queued[i] >= header->flight_count) {
+            return "invalid airport state";
+        }
+    }
+
+    for (uint32_t i = 0; i < header->runway_count; i++) {
+        if (runways[i] >= header->airport_count) {
+            return "invalid runway state";
+        }
+    }
+
+    if (header->event_count > header->flight_count ||
+        header->runway_count > header->airport_count) {
+        return "invalid event queue";
+    }
+
+    for (uint32_t i = 0; i < header->event_count; i++) {
+        if (EVENT_FLIGHT(events[i]) >= header->flight_count ||
+            (i > 0 && events[(i - 1) / 2] > events[i])) {
+            return "invalid event queue";
+        }
+    }
+
+#undef VALID_FLIGHT
+
+    return NULL;
+}
+
+/**
+ * @brief   Restores the state of the simulation from a checkpoint.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Must hold the schedule the checkpoint was taken from, sorted,
+ *             with the airports initialized and nothing simulated yet.
+ * @param   [in] path: const char*
+ *          -- Path of the checkpoint to read.
+ * @details Everything in the checkpoint is checked before any of it is
+ *          restored, so a checkpoint that fails to load changes nothing.
+ * @return  bool
+ *          -- True if the state was restored, False if the checkpoint
+ *             couldn't be read or doesn't belong to this schedule.
+ */
+bool load_checkpoint(simulation_param_t *sim_param, const char *path)
+{
+    size_t file_size;
+    const uint8_t *data = map_file(path, &file_size);
+    const char *error = NULL;
+    checkpoint_header_t header;
+    checkpoint_layout_t layout;
+
+    if (data == NULL) {
+        return false;
+    }
+
+    if (file_size < sizeof(header)) {
+        error = "not a checkpoint";
+    }
+    else {
+        memcpy(&header, data, sizeof(header));
+        checkpoint_layout(&header, &layout);
+
+        if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic))) {
+            error = "not a checkpoint";
+        }
+        else if (header.version != CHECKPOINT_VERSION) {
+            error = "unsupported checkpoint version";
+        }
+        else if (layout.size != file_size) {
+            error = "truncated checkpoint";
+        }
+        else if (header.flight_count != sim_param->flight_count ||
+                 header.airport_count != sim_param->airports.count ||
+                 header.plane_count != sim_param->planes.count ||
+                 header.fingerprint != schedule_fingerprint(sim_param)) {
+            error = "checkpoint was taken from a different schedule";
+        }
+        else {
+            error = check_checkpoint(sim_param, &header, &layout, data);
+        }
+    }
+
+    if (error != NULL) {
+        fprintf(stderr, "atsim: %s: %s\n", path, error);
+        unmap_file(data, file_size);
+        return false;
+    }
+
+    const checkpoint_flight_t *flights = (const checkpoint_flight_t *)
+            (data + layout.flights);
+    const checkpoint_plane_t *planes = (const checkpoint_plane_t *)
+            (data + layout.planes);
+    const checkpoint_airport_t *airports = (const checkpoint_airport_t *)
+            (data + layout.airports);
+    const uint32_t *queued = (const uint32_t *)(data + layout.queued);
+    const uint32_t *runways = (const uint32_t *)(data + layout.runways);
+
+    for (uint32_t i = 0; i < header.flight_count; i++) {
+        flight_t *flight = &sim_param->flights[i];
+
+        flight->time.departure = flights[i].departure;
+        flight->time.arrival   = flights[i].arrival;
+        flight->state          = (flight_states_t)flights[i].state;
+        sim_param->flight_info[i].next_waiting = flights[i].next_waiting;
+    }
+
+    for (uint32_t i = 0; i < header.plane_count; i++) {
+        plane_t *plane = PLANE(sim_param, i);
+
+        plane->airport  = planes[i].airport;
+        plane->ready_at = planes[i].ready_at;
+        plane->waiting  = planes[i].waiting;
+    }
+
+    for (uint32_t i = 0; i < header.airport_count; i++) {
+        airport_t *airport = AIRPORT(sim_param, i);
+
+        airport->last_queue_type = (queue_types_t)airports[i].last_queue_type;
+        airport->runway_active   = (airports[i].runway_active != 0);
+
+        for (uint32_t j = 0; j < airports[i].departures; j++) {
+            enqueue(&airport->departures_queue, *queued++);
+        }
+
+        for (uint32_t j = 0; j < airports[i].arrivals; j++) {
+            enqueue(&airport->arrivals_queue, *queued++);
+        }
+    }
+
+    for (uint32_t i = 0; i < header.runway_count; i++) {
+        sim_param->runway_airports[i] = AIRPORT(sim_param, runways[i]);
+    }
+
+    memcpy(sim_param->events.heap, data + layout.events,
+           (size_t)header.event_count * sizeof(sim_event_t));
+    sim_param->events.count = header.event_count;
+    sim_param->runway_count = header.runway_count;
+    sim_param->clock        = header.clock;
+
+    unmap_file(data, file_size);
+    return true;
+}
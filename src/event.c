@@ -0,0 +1,165 @@
+/**
+ * @file    event.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that initialize
+ *          and manage the event queue used to advance the simulation clock.
+ */
+
+#include <stdlib.h>
+#include "event.h"
+
+/**
+ * @brief   Initializes an event queue.
+ * @param   [out] queue: event_queue_t*
+ *                       -- Pointer to an event queue data type.
+ * @param   [in] capacity: uint32_t
+ *                         -- Number of events the queue must be able to hold.
+ * @details The event queue is implemented as a binary min-heap laid out in
+ *          an array, so the earliest event is always at the front.
+ * @return  bool
+ *          -- True if the queue was initialized, False if its array couldn't
+ *             be allocated.
+ */
+bool init_event_queue(event_queue_t *queue, uint32_t capacity)
+{
+    queue->heap     = malloc(((size_t)capacity + 1) * sizeof(sim_event_t));
+    queue->count    = 0;
+    queue->capacity = (queue->heap != NULL) ? capacity : 0;
+
+    return (queue->heap != NULL);
+}
+
+/**
+ * @brief   Deinitializes an event queue, releasing its array.
+ * @param   [out] queue: event_queue_t*
+ *                       -- Pointer to an event queue data type.
+ */
+void deinit_event_queue(event_queue_t *queue)
+{
+    free(queue->heap);
+    queue->heap     = NULL;
+    queue->count    = 0;
+    queue->capacity = 0;
+}
+
+/**
+ * @brief   Empties an event queue, making sure it can hold a given number of
+ *          events.
+ * @param   [in, out] queue: event_queue_t*
+ *                           -- Pointer to an event queue data type.
+ * @param   [in] capacity: uint32_t
+ *                         -- Number of events the queue must be able to hold.
+ * @details The queue's array is only reallocated if it's too small, so a
+ *          queue reused across simulations settles on the largest one.
+ * @return  bool
+ *          -- True if the queue can hold the events, False if its array
+ *             couldn't be grown.
+ */
+bool reset_event_queue(event_queue_t *queue, uint32_t capacity)
+{
+    queue->count = 0;
+
+    if (queue->heap != NULL && queue->capacity >= capacity) {
+        return true;
+    }
+
+    sim_event_t *heap = realloc(queue->heap,
+                                ((size_t)capacity + 1) * sizeof(sim_event_t));
+
+    if (heap == NULL) {
+        return false;
+    }
+
+    queue->heap     = heap;
+    queue->capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief   Pushes an event into an event queue.
+ * @param   [in, out] queue: event_queue_t*
+ *                           -- Pointer to an event queue data type.
+ * @param   [in] event: sim_event_t
+ *                      -- Event to be queued.
+ * @details The event is placed at the end of the heap and sifted up
+ *          until its parent is no later than it.
+ * @return  bool
+ *          -- True if the event was queued, False if the queue is full.
+ */
+bool push_event(event_queue_t *queue, sim_event_t event)
+{
+    if (queue->count == queue->capacity) {
+        return false;
+    }
+
+    uint32_t i = queue->count++;
+
+    while (i > 0 && queue->heap[(i - 1) / 2] > event) {
+        queue->heap[i] = queue->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+
+    queue->heap[i] = event;
+    return true;
+}
+
+/**
+ * @brief   Pops the earliest event from an event queue.
+ * @param   [in, out] queue: event_queue_t*
+ *                           -- Pointer to a non-empty event queue.
+ * @details The last event of the heap is moved to the front and sifted
+ *          down until both of its children are no earlier than it.
+ * @return  sim_event_t
+ *          -- The earliest event in the queue.
+ */
+sim_event_t pop_event(event_queue_t *queue)
+{
+    sim_event_t front = queue->heap[0];
+    sim_event_t last = queue->heap[--queue->count];
+    uint32_t i = 0, child;
+
+    while ((child = 2*i + 1) < queue->count) {
+        if (child + 1 < queue->count &&
+            queue->heap[child + 1] < queue->heap[child]) {
+            child++;
+        }
+
+        if (queue->heap[child] >= last) {
+            break;
+        }
+
+        queue->heap[i] = queue->heap[child];
+        i = child;
+    }
+
+    queue->heap[i] = last;
+    return front;
+}
+
+/**
+ * @brief   Finds the clock tick of the earliest event in an event queue.
+ * @param   [in] queue: event_queue_t*
+ *                      -- Pointer to an event queue data type.
+ * @return  uint32_t
+ *          -- Clock tick of the earliest event, or NO_EVENT if the queue
+ *             is empty.
+ */
+uint32_t next_event_clock(event_queue_t *queue)
+{
+    return (queue->count > 0) ? EVENT_CLOCK(queue->heap[0]) : NO_EVENT;
+}
+
+/**
+ * @brief   Looks at the earliest event in an event queue without taking it
+ *          out.
+ * @param   [in] queue: event_queue_t*
+ *                      -- Pointer to an event queue data type.
+ * @return  sim_event_t
+ *          -- The earliest event, or EVENT_NONE if the queue is empty, which
+ *             orders after every other event.
+ */
+sim_event_t next_event(event_queue_t *queue)
+{
+    return (queue->count > 0) ? queue->heap[0] : EVENT_NONE;
+}
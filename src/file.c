@@ -0,0 +1,90 @@
+/**
+ * @file    file.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies used to read and write
+ *          the simulation's binary files whole.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "file.h"
+
+/**
+ * @brief   Maps a file into memory, read only.
+ * @param   [in] path: const char*
+ *                     -- Path of the file to map.
+ * @param   [out] size: size_t*
+ *                      -- Gets the size of the file.
+ * @details Failures are reported on stderr. An empty file can't be mapped,
+ *          so it is reported as such too.
+ * @return  const void*
+ *          -- Start of the mapped file, or NULL if it couldn't be mapped.
+ */
+const void* map_file(const char *path, size_t *size)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat status;
+    void *data = MAP_FAILED;
+
+    if (fd >= 0 && fstat(fd, &status) == 0) {
+        *size = status.st_size;
+        errno = (*size > 0) ? errno : EINVAL;
+        data = (*size > 0) ?
+               mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    }
+
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "atsim: %s: %s\n", path, strerror(errno));
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    return (data != MAP_FAILED) ? data : NULL;
+}
+
+/**
+ * @brief   Unmaps a file mapped by map_file.
+ * @param   [in] data: const void*
+ *                     -- Start of the mapped file.
+ * @param   [in] size: size_t
+ *                     -- Size of the file.
+ */
+void unmap_file(const void *data, size_t size)
+{
+    munmap((void *)data, size);
+}
+
+/**
+ * @brief   Writes a buffer out as a whole file, replacing any old one.
+ * @param   [in] path: const char*
+ *                     -- Path of the file to write.
+ * @param   [in] data: const void*
+ *                     -- Contents of the file.
+ * @param   [in] size: size_t
+ *                     -- Size of the contents.
+ * @details Failures are reported on stderr.
+ * @return  bool
+ *          -- True if the whole file was written, False if not.
+ */
+bool write_file(const char *path, const void *data, size_t size)
+{
+    FILE *file = fopen(path, "wb");
+    bool written = (file != NULL && fwrite(data, 1, size, file) == size);
+
+    written = (file != NULL && fclose(file) == 0) && written;
+
+    if (!written) {
+        fprintf(stderr, "atsim: %s: %s\n", path, strerror(errno));
+    }
+
+    return written;
+}
@@ -0,0 +1,229 @@
+/**
+ * @file    metrics.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that record how each
+ *          airport's runway is used and report it once the simulation is over.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "metrics.h"
+
+static const char *queue_names[QUEUE_TYPES] = {"departures", "arrivals"};
+
+static const char *bucket_names[METRICS_DEPTH_BUCKETS] = {
+        "0", "1", "2-3", "4-7", "8-15", "16-31", "32-63", "64-127", "128+"
+};
+
+/**
+ * @brief   Gives every airport of a simulation its runway metrics.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Its airports have to be initialized already.
+ * @details The metrics of the last simulation are dropped, so each
+ *          simulation starts from zero.
+ * @return  bool
+ *          -- True if the metrics were allocated, False if not.
+ */
+bool init_runway_metrics(simulation_param_t *sim_param)
+{
+    uint32_t count = sim_param->airports.count;
+    size_t bytes = ((count > 0) ? count : 1) * sizeof(runway_metrics_t);
+
+    free(sim_param->runway_metrics);
+    sim_param->runway_metrics = aligned_alloc(METRICS_CACHE_LINE, bytes);
+
+    if (sim_param->runway_metrics == NULL) {
+        return false;
+    }
+
+    memset(sim_param->runway_metrics, 0, bytes);
+
+    for (uint32_t i = 0; i < count; i++) {
+        AIRPORT(sim_param, i)->metrics = &sim_param->runway_metrics[i];
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Records a flight being served by an airport's runway.
+ * @param   [in, out] metrics: runway_metrics_t*
+ *          -- Pointer to the metrics of the airport.
+ * @param   [in] queues: flight_queue_t**
+ *          -- The airport's queues, by queue type, once the flight has been
+ *             taken out of its own.
+ * @param   [in] served: queue_types_t
+ *          -- Queue the flight was taken out of.
+ * @param   [in] alternated: bool
+ *          -- Whether the last flight served came out of the other queue.
+ * @param   [in] flight: flight_t*
+ *          -- Pointer to the flight, before it's moved along.
+ * @param   [in] sim_clock: uint32_t
+ *          -- Current simulation clock tick.
+ * @details A flight queues for takeoff once it's done taxiing out, and
+ *          queues for landing once its flight time is over, which is when
+ *          its wait starts.
+ */
+void record_runway_use(runway_metrics_t *metrics, flight_queue_t **queues,
+                       queue_types_t served, bool alternated,
+                       flight_t *flight, uint32_t sim_clock)
+{
+    uint32_t queued = flight->time.departure + ((served == DEPARTURE) ?
+            flight->taxi_out : flight->time.flight);
+    uint32_t wait = sim_clock - queued;
+
+    metrics->served[served]++;
+    metrics->alternations += alternated;
+    metrics->total_wait[served] += wait;
+
+    if (wait > metrics->max_wait[served]) {
+        metrics->max_wait[served] = wait;
+    }
+
+    for (int i = 0; i < QUEUE_TYPES; i++) {
+        uint32_t depth = size(queues[i]) + (i == (int)served);
+        int bucket = (depth == 0) ? 0 : 32 - __builtin_clz(depth);
+
+        if (bucket >= METRICS_DEPTH_BUCKETS) {
+            bucket = METRICS_DEPTH_BUCKETS - 1;
+        }
+
+        metrics->depth[i][bucket]++;
+    }
+}
+
+/**
+ * @brief   Writes a line of the runway report.
+ * @param   [in] file: FILE*
+ *          -- File the report is written to.
+ * @param   [in] code: const char*
+ *          -- Code of the airport, or the name of the line.
+ * @param   [in] metrics: const runway_metrics_t*
+ *          -- Pointer to the metrics the line is about.
+ * @param   [in] minutes: uint32_t
+ *          -- Minutes the simulation ran for.
+ * @param   [in] runways: uint32_t
+ *          -- Number of runways the line covers.
+ */
+static void write_runway_line(FILE *file, const char *code,
+                              const runway_metrics_t *metrics,
+                              uint32_t minutes, uint32_t runways)
+{
+    uint64_t busy = (uint64_t)metrics->served[DEPARTURE] +
+                    metrics->served[ARRIVAL];
+    uint64_t span = (uint64_t)minutes * runways;
+
+    fprintf(file, "%s,%llu,%.4f,%u,%u,%u", code, (unsigned long long)busy,
+            (span > 0) ? (double)busy / span : 0.0,
+            metrics->served[DEPARTURE], metrics->served[ARRIVAL],
+            metrics->alternations);
+
+    for (int i = 0; i < QUEUE_TYPES; i++) {
+        fprintf(file, ",%.2f,%u", (metrics->served[i] > 0) ?
+                        (double)metrics->total_wait[i] / metrics->served[i] :
+                        0.0,
+                metrics->max_wait[i]);
+    }
+
+    // The minutes a runway isn't served on both of its queues are empty.
+    for (int i = 0; i < QUEUE_TYPES; i++) {
+        for (int j = 0; j < METRICS_DEPTH_BUCKETS; j++) {
+            fprintf(file, ",%llu", (unsigned long long)metrics->depth[i][j] +
+                                   ((j == 0) ? span - busy : 0));
+        }
+    }
+
+    fputc('\n', file);
+}
+
+/**
+ * @brief   Writes the runway metrics of a simulation as CSV.
+ * @param   [in] sim_param: const simulation_param_t*
+ *          -- Pointer to a simulation that ran with runway metrics.
+ * @param   [in] path: const char*
+ *          -- File the report is written to, or NULL for standard error.
+ * @details There is one line per airport, in the order they were first seen
+ *          in the schedule, and a last line named "total" that merges them
+ *          all. Utilization is the share of the simulated minutes, from the
+ *          first tick to the last one, that the runway was used on. Waits are
+ *          in minutes, and the depths count the minutes each queue was that
+ *          long on, as the runway was about to be used.
+ * @return  bool
+ *          -- True if the report was written, False if not.
+ */
+bool write_runway_report(const simulation_param_t *sim_param,
+                         const char *path)
+{
+    uint32_t count = sim_param->airports.count;
+    uint32_t minutes = (sim_param->last_clock == NO_EVENT) ? 0 :
+            sim_param->last_clock - sim_param->first_clock + 1;
+    runway_metrics_t total;
+    FILE *file = (path != NULL) ? fopen(path, "w") : stderr;
+
+    if (file == NULL) {
+        fprintf(stderr, "atsim: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    memset(&total, 0, sizeof(total));
+    fprintf(file, "airport,busy,utilization,takeoffs,landings,alternations");
+
+    for (int i = 0; i < QUEUE_TYPES; i++) {
+        fprintf(file, ",%s_wait_mean,%s_wait_max", queue_names[i],
+                queue_names[i]);
+    }
+
+    for (int i = 0; i < QUEUE_TYPES; i++) {
+        for (int j = 0; j < METRICS_DEPTH_BUCKETS; j++) {
+            fprintf(file, ",%s_depth_%s", queue_names[i], bucket_names[j]);
+        }
+    }
+
+    fputc('\n', file);
+
+    // Nothing is recorded if the simulation ended before it started.
+    if (sim_param->runway_metrics == NULL) {
+        count = 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const runway_metrics_t *metrics = &sim_param->runway_metrics[i];
+
+        write_runway_line(file, AIRPORT(sim_param, i)->code, metrics, minutes,
+                          1);
+
+        total.alternations += metrics->alternations;
+
+        for (int j = 0; j < QUEUE_TYPES; j++) {
+            total.served[j] += metrics->served[j];
+            total.total_wait[j] += metrics->total_wait[j];
+
+            if (metrics->max_wait[j] > total.max_wait[j]) {
+                total.max_wait[j] = metrics->max_wait[j];
+            }
+
+            for (int k = 0; k < METRICS_DEPTH_BUCKETS; k++) {
+                total.depth[j][k] += metrics->depth[j][k];
+            }
+        }
+    }
+
+    write_runway_line(file, "total", &total, minutes, count);
+
+    bool written = !ferror(file);
+
+    if (path != NULL && fclose(file) != 0) {
+        written = false;
+    }
+
+    if (!written) {
+        fprintf(stderr, "atsim: the runway report couldn't be written\n");
+    }
+
+    return written;
+}
@@ -0,0 +1,481 @@
+/**
+ * @file    montecarlo.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that run replicates of a
+ *          schedule with randomly perturbed taxi, flight and grooming
+ *          durations on a pool of threads, and that report the percentiles
+ *          of the delays they end up with.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "montecarlo.h"
+#include "schedule.h"
+#include "simulation.h"
+
+#define RANDOM_GOLDEN_GAMMA 0x9E3779B97F4A7C15ull
+#define RANDOM_TWO_PI       6.283185307179586
+
+// Percentiles of the delays that are reported.
+static const uint32_t DELAY_PERCENTILES[] = {50, 90, 99};
+
+/**
+ * @brief   Mixes the bits of a 64 bit value, as the splitmix64 generator does.
+ * @param   [in] value: uint64_t
+ *                      -- Value to be mixed.
+ * @return  uint64_t
+ *          -- Mixed value.
+ */
+static inline uint64_t mix_random(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief   Draws the next number of a splitmix64 random stream.
+ * @param   [in, out] state: uint64_t*
+ *                           -- State of the stream.
+ * @return  uint64_t
+ *          -- Uniformly distributed random number.
+ */
+static inline uint64_t next_random(uint64_t *state)
+{
+    *state += RANDOM_GOLDEN_GAMMA;
+    return mix_random(*state);
+}
+
+/**
+ * @brief   Draws a standard normally distributed number.
+ * @param   [in, out] state: uint64_t*
+ *                           -- State of the random stream drawn from.
+ * @details Uses the Box-Muller transform. The top 53 bits of each draw make
+ *          up a double, the first one kept off zero so its log is finite.
+ * @return  double
+ *          -- Random number with a mean of 0 and a standard deviation of 1.
+ */
+static double random_normal(uint64_t *state)
+{
+    double u1 = (double)((next_random(state) >> 11) + 1) * 0x1.0p-53;
+    double u2 = (double)(next_random(state) >> 11) * 0x1.0p-53;
+
+    return sqrt(-2.0 * log(u1)) * cos(RANDOM_TWO_PI * u2);
+}
+
+/**
+ * @brief   Perturbs a duration.
+ * @param   [in] duration: uint32_t
+ *                         -- Nominal duration, in minutes.
+ * @param   [in] max: uint32_t
+ *                    -- Longest the duration can be stored as.
+ * @param   [in] sigma: double
+ *                      -- Spread of the perturbation.
+ * @param   [in, out] state: uint64_t*
+ *                           -- State of the random stream drawn from.
+ * @details The duration is scaled by a log-normal factor with a mean of 1,
+ *          which keeps it positive and skews it towards running late.
+ *          It's rounded to at least a minute, as an event can't be scheduled
+ *          on the tick that raises it. A duration of zero is left alone, as a
+ *          flight with no duration never lands anyway.
+ * @return  uint32_t
+ *          -- Perturbed duration, in minutes.
+ */
+static uint32_t perturb_duration(uint32_t duration, uint32_t max, double sigma,
+                                 uint64_t *state)
+{
+    double factor = exp(sigma * random_normal(state) - sigma * sigma / 2.0);
+    double rounded = duration * factor + 0.5;
+
+    if (duration == 0) {
+        return 0;
+    }
+
+    return (rounded < 1.0) ? 1 : (rounded >= max) ? max : (uint32_t)rounded;
+}
+
+/**
+ * @brief   Compares two delays, for qsort.
+ * @param   [in] a: const void*
+ *                  -- Pointer to the first delay.
+ * @param   [in] b: const void*
+ *                  -- Pointer to the second delay.
+ * @return  int
+ *          -- Negative, zero or positive as the first delay is shorter,
+ *             the same or longer than the second.
+ */
+static int compare_delays(const void *a, const void *b)
+{
+    int32_t first = *(const int32_t *)a, second = *(const int32_t *)b;
+
+    return (first > second) - (first < second);
+}
+
+/**
+ * @brief   Finds the delay a flight completed with.
+ * @param   [in] flight: const flight_t*
+ *                       -- Pointer to the flight, with its nominal durations.
+ * @param   [in] arrival: uint32_t
+ *                        -- Clock tick the flight completed at.
+ * @details Measured the same way as in the results of a single simulation,
+ *          so perturbed durations can make it negative.
+ * @return  int32_t
+ *          -- Delay of the flight, in minutes.
+ */
+static int32_t flight_delay(const flight_t *flight, uint32_t arrival)
+{
+    return (int32_t)((int64_t)arrival - flight->time.scheduled -
+                     flight->time.flight - 2*TAXI_DURATION);
+}
+
+/**
+ * @brief   Runs replicates of a schedule and reports their delays.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Its worker count is the number of replicates run at once. The
+ *             schedule is read into its stores and the report goes to its
+ *             output.
+ * @param   [in] input_fd: int
+ *          -- File descriptor the schedule is read from, unless a compiled
+ *             schedule is loaded instead.
+ * @details Each thread runs whole replicates, so the replicates serve their
+ *          runways without workers of their own. The calling thread takes a
+ *          share of the replicates as well.
+ *          The completions of every replicate are kept until the end, which
+ *          takes 4 bytes per flight and replicate.
+ * @return  bool
+ *          -- True if every replicate ran and the report was written, False
+ *             if not.
+ */
+bool run_monte_carlo(simulation_param_t *sim_param, int input_fd)
+{
+    if (!load_schedule(sim_param, input_fd)) {
+        return false;
+    }
+
+    uint32_t flights = sim_param->flight_count;
+    uint32_t threads = (sim_param->worker_count < sim_param->replicates) ?
+            sim_param->worker_count : sim_param->replicates;
+    // Every worker_t of the simulations sits on cache lines of its own.
+    replicate_worker_t *workers =
+            aligned_alloc(WORKER_CACHE_LINE,
+                          threads * sizeof(replicate_worker_t));
+    monte_carlo_t monte_carlo = {
+            .schedule    = sim_param,
+            .completions = malloc((size_t)sim_param->replicates * flights *
+                                  sizeof(uint32_t) + 1),
+            .replicates  = sim_param->replicates,
+            .spread      = sim_param->spread,
+            .seed        = sim_param->seed
+    };
+    uint32_t ready = 0, started = 1;
+    bool sorted = sort_flights(sim_param);
+
+    atomic_init(&monte_carlo.next, 0);
+    atomic_init(&monte_carlo.failed, 0);
+
+    // The replicates' stores are sized to the schedule, so copying it
+    // never has them grow.
+    for (; sorted && workers != NULL && monte_carlo.completions != NULL &&
+           ready < threads; ready++) {
+        simulation_param_t *replicate = &workers[ready].sim;
+
+        *replicate = *sim_param;
+        replicate->worker_count = 1;
+        memset(&replicate->output, 0, sizeof(output_t));
+        replicate->output.fd = -1;
+        workers[ready].monte_carlo = &monte_carlo;
+
+        if (!init_stores(replicate, flights, sim_param->airports.count,
+                         sim_param->planes.count)) {
+            deinit_stores(replicate);
+            break;
+        }
+    }
+
+    if (ready < threads) {
+        fprintf(stderr, "atsim: out of memory\n");
+    }
+    else {
+        while (started < threads &&
+               pthread_create(&workers[started].thread, NULL,
+                              replicate_worker, &workers[started]) == 0) {
+            started++;
+        }
+
+        replicate_worker(&workers[0]);
+
+        for (uint32_t i = 1; i < started; i++) {
+            pthread_join(workers[i].thread, NULL);
+        }
+    }
+
+    bool success = (ready == threads &&
+                    atomic_load(&monte_carlo.failed) == 0);
+
+    if (success) {
+        success = output_delay_report(&monte_carlo, &sim_param->output);
+    }
+
+    for (uint32_t i = 0; i < ready; i++) {
+        deinit_stores(&workers[i].sim);
+    }
+
+    free(workers);
+    free(monte_carlo.completions);
+    return success;
+}
+
+/**
+ * @brief   Replicate thread function.
+ * @param   [in] arg: [void *]
+ *          -- Pointer to the replicate worker the thread runs as.
+ * @return  [void *]
+ *          -- Will always return NULL.
+ * @details The thread keeps taking the next replicate until there are none
+ *          left.
+ */
+void* replicate_worker(void *arg)
+{
+    replicate_worker_t *worker = arg;
+    monte_carlo_t *monte_carlo = worker->monte_carlo;
+    uint32_t replicate;
+
+    while ((replicate = atomic_fetch_add(&monte_carlo->next, 1)) <
+           monte_carlo->replicates) {
+        if (!run_replicate(&worker->sim, monte_carlo, replicate)) {
+            atomic_fetch_add(&monte_carlo->failed, 1);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief   Runs a single replicate of a schedule.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to the simulation of the thread running the replicate.
+ *          -- Its stores are emptied once the replicate has run.
+ * @param   [in] monte_carlo: const monte_carlo_t*
+ *          -- Pointer to the Monte Carlo run the replicate is part of.
+ * @param   [in] replicate: uint32_t
+ *          -- Index of the replicate, which picks its row of completions
+ *             and its random stream.
+ * @return  bool
+ *          -- True if the replicate ran to the end, False if not.
+ */
+bool run_replicate(simulation_param_t *sim_param,
+                   const monte_carlo_t *monte_carlo, uint32_t replicate)
+{
+    uint32_t flights = monte_carlo->schedule->flight_count;
+    uint32_t *completions = monte_carlo->completions +
+                            (size_t)replicate * flights;
+    bool success = copy_schedule(sim_param, monte_carlo->schedule);
+
+    for (uint32_t i = 0; i < flights; i++) {
+        completions[i] = NO_EVENT;
+    }
+
+    if (!success) {
+        fprintf(stderr, "atsim: out of memory\n");
+    }
+    else {
+        perturb_schedule(sim_param, monte_carlo->seed, replicate,
+                         monte_carlo->spread);
+        sim_param->completions = completions;
+        success = run_simulation(sim_param, -1);
+    }
+
+    reset_stores(sim_param);
+    return success;
+}
+
+/**
+ * @brief   Perturbs the durations of a replicate's flights.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the durations of the simulation's flights.
+ * @param   [in] seed: uint64_t
+ *          -- Seed of the Monte Carlo run.
+ * @param   [in] replicate: uint32_t
+ *          -- Index of the replicate.
+ * @param   [in] spread: uint32_t
+ *          -- Spread of the durations, in percent of their nominal length.
+ * @details Every replicate draws from its own stream, seeded by the seed and
+ *          its index, and goes through the flights in order. The replicates
+ *          then don't depend on how they're spread over the threads.
+ *          Each flight draws its taxi out, flight, taxi in and grooming
+ *          durations, in that order. Flight times may run past the horizon,
+ *          as the schedule's may; they're only held to their field.
+ */
+void perturb_schedule(simulation_param_t *sim_param, uint64_t seed,
+                      uint32_t replicate, uint32_t spread)
+{
+    uint64_t state = mix_random(seed ^ mix_random((uint64_t)replicate + 1));
+    double sigma = spread / 100.0;
+
+    for (uint32_t i = 0; i < sim_param->flight_count; i++) {
+        flight_t *flight = &sim_param->flights[i];
+
+        flight->taxi_out = perturb_duration(flight->taxi_out, UINT8_MAX,
+                                            sigma, &state);
+        flight->time.flight = perturb_duration(flight->time.flight, UINT32_MAX,
+                                               sigma, &state);
+        flight->taxi_in = perturb_duration(flight->taxi_in, UINT8_MAX,
+                                           sigma, &state);
+        flight->groom = perturb_duration(flight->groom, UINT8_MAX,
+                                         sigma, &state);
+    }
+}
+
+/**
+ * @brief   Outputs the percentiles of a group of delays.
+ * @param   [in, out] output: output_t*
+ *                            -- Output the line is written to.
+ * @param   [in] label: const char*
+ *                      -- What the delays are of.
+ * @param   [in, out] delays: int32_t*
+ *                            -- Delays of the completed flights, which are
+ *                               sorted.
+ * @param   [in] completed: uint32_t
+ *                          -- Number of delays.
+ * @param   [in] total: uint32_t
+ *                      -- Number of flights that could have completed.
+ * @details Percentiles use the nearest rank.
+ */
+static void output_delay_line(output_t *output, const char *label,
+                              int32_t *delays, uint32_t completed,
+                              uint32_t total)
+{
+    int32_t values[sizeof(DELAY_PERCENTILES) / sizeof(uint32_t)];
+
+    if (completed == 0) {
+        output_text(output, "%s, completed 0/%" PRIu32 "\n", label, total);
+        return;
+    }
+
+    qsort(delays, completed, sizeof(int32_t), compare_delays);
+
+    for (uint32_t i = 0; i < sizeof(values) / sizeof(int32_t); i++) {
+        uint64_t rank = ((uint64_t)DELAY_PERCENTILES[i] * completed + 99) /
+                        100;
+
+        values[i] = delays[rank - 1];
+    }
+
+    output_text(output, "%s, delay p50 %" PRId32 " p90 %" PRId32
+                        " p99 %" PRId32 ", completed %" PRIu32 "/%" PRIu32
+                        "\n",
+                label, values[0], values[1], values[2], completed, total);
+}
+
+/**
+ * @brief   Outputs the percentiles of the delays of every flight, and of the
+ *          flights departing from every airport.
+ * @param   [in] monte_carlo: const monte_carlo_t*
+ *          -- Pointer to a Monte Carlo run whose replicates all ran.
+ * @param   [in, out] output: output_t*
+ *          -- Output the report is written to.
+ * @details Flights that didn't complete within the simulated days are only
+ *          counted as such.
+ *          Flights are reported in flight order, then airports in the order
+ *          they first show up in the schedule.
+ * @return  bool
+ *          -- True if the report was output, False if memory ran out.
+ */
+bool output_delay_report(const monte_carlo_t *monte_carlo, output_t *output)
+{
+    const simulation_param_t *schedule = monte_carlo->schedule;
+    uint32_t flights = schedule->flight_count;
+    uint32_t airports = schedule->airports.count;
+    uint32_t replicates = monte_carlo->replicates;
+    uint32_t *starts = calloc((size_t)airports + 1, sizeof(uint32_t));
+    uint32_t *by_origin = malloc((size_t)flights * sizeof(uint32_t) + 1);
+    uint64_t most = replicates;
+    int32_t *delays;
+    char label[OUTPUT_LINE_MAX];
+
+    // Flights are grouped by their origin with a counting sort.
+    for (uint32_t i = 0; starts != NULL && i < flights; i++) {
+        starts[schedule->flights[i].origin + 1]++;
+    }
+
+    for (uint32_t a = 0; starts != NULL && a < airports; a++) {
+        uint64_t samples = (uint64_t)starts[a + 1] * replicates;
+
+        most = (samples > most) ? samples : most;
+        starts[a + 1] += starts[a];
+    }
+
+    if (starts == NULL || by_origin == NULL ||
+        (delays = malloc((size_t)most * sizeof(int32_t) + 1)) == NULL) {
+        fprintf(stderr, "atsim: out of memory, no report was written\n");
+        free(starts);
+        free(by_origin);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < flights; i++) {
+        by_origin[starts[schedule->flights[i].origin]++] = i;
+    }
+
+    // Every airport's start was moved to the next one's by the grouping.
+    for (uint32_t a = airports; a > 0; a--) {
+        starts[a] = starts[a - 1];
+    }
+
+    starts[0] = 0;
+
+    for (uint32_t i = 0; i < flights; i++) {
+        const flight_t *flight = &schedule->flights[i];
+        const flight_info_t *info = &schedule->flight_info[i];
+        uint32_t completed = 0;
+
+        for (uint32_t r = 0; r < replicates; r++) {
+            uint32_t arrival =
+                    monte_carlo->completions[(size_t)r * flights + i];
+
+            if (arrival != NO_EVENT) {
+                delays[completed++] = flight_delay(flight, arrival);
+            }
+        }
+
+        snprintf(label, sizeof(label), "flight %s %u from %s to %s",
+                 info->carrier, (unsigned)info->number,
+                 AIRPORT(schedule, flight->origin)->code,
+                 AIRPORT(schedule, flight->destination)->code);
+        output_delay_line(output, label, delays, completed, replicates);
+    }
+
+    for (uint32_t a = 0; a < airports; a++) {
+        uint32_t completed = 0;
+
+        for (uint32_t k = starts[a]; k < starts[a + 1]; k++) {
+            const flight_t *flight = &schedule->flights[by_origin[k]];
+
+            for (uint32_t r = 0; r < replicates; r++) {
+                uint32_t arrival = monte_carlo->completions[
+                        (size_t)r * flights + by_origin[k]];
+
+                if (arrival != NO_EVENT) {
+                    delays[completed++] = flight_delay(flight, arrival);
+                }
+            }
+        }
+
+        snprintf(label, sizeof(label), "airport %s departures",
+                 AIRPORT(schedule, a)->code);
+        output_delay_line(output, label, delays, completed,
+                          (starts[a + 1] - starts[a]) * replicates);
+    }
+
+    free(starts);
+    free(by_origin);
+    free(delays);
+    return true;
+}
@@ -0,0 +1,300 @@
+/**
+ * @file    output.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that format the
+ *          simulation's results into a buffer and write it out.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "output.h"
+#include "airport.h"
+
+static const char digit_pairs[] =
+        "00010203040506070809101112131415161718192021222324"
+        "25262728293031323334353637383940414243444546474849"
+        "50515253545556575859606162636465666768697071727374"
+        "75767778798081828384858687888990919293949596979899";
+
+static char time_table[OUTPUT_TIME_TABLE_SIZE][OUTPUT_TIME_LENGTH];
+static bool time_table_ready = false;
+
+/**
+ * @brief   Writes an unsigned number in decimal, like printf's %d.
+ * @param   [out] text: char*
+ *                      -- Where the digits are written.
+ * @param   [in] value: uint32_t
+ *                      -- Number to write.
+ * @param   [in] width: uint32_t
+ *                      -- Least number of digits, padded with zeros.
+ * @details Digits are produced two at a time from a lookup table, starting
+ *          from the least significant pair.
+ * @return  char*
+ *          -- Position after the last digit.
+ */
+static char* write_number(char *text, uint32_t value, uint32_t width)
+{
+    char digits[10];
+    uint32_t count = 0;
+
+    while (value >= 100) {
+        uint32_t pair = (value % 100) * 2;
+        value /= 100;
+        digits[9 - count++] = digit_pairs[pair + 1];
+        digits[9 - count++] = digit_pairs[pair];
+    }
+
+    if (value >= 10) {
+        digits[9 - count++] = digit_pairs[value * 2 + 1];
+        digits[9 - count++] = digit_pairs[value * 2];
+    }
+    else {
+        digits[9 - count++] = (char)('0' + value);
+    }
+
+    while (count < width) {
+        digits[9 - count++] = '0';
+    }
+
+    memcpy(text, &digits[10 - count], count);
+    return text + count;
+}
+
+/**
+ * @brief   Writes a simulation clock value as simulation time.
+ * @param   [in] output: output_t*
+ *                       -- Output the time is written for.
+ * @param   [out] text: char*
+ *                      -- Where the time is written.
+ * @param   [in] clock: uint32_t
+ *                      -- Simulation clock value.
+ * @details Simulations that span several days write times as D:HH:MM.
+ *          Otherwise, clock values within the table are copied from it, and
+ *          any other is converted the same way sim_ClockToTime does.
+ * @return  char*
+ *          -- Position after the time.
+ */
+static char* write_time(output_t *output, char *text, uint32_t clock)
+{
+    if (output->day_times) {
+        text = write_number(text, clock / MINUTES_PER_DAY, 1);
+        *text++ = ':';
+        clock %= MINUTES_PER_DAY;
+    }
+
+    if (clock < OUTPUT_TIME_TABLE_SIZE) {
+        memcpy(text, time_table[clock], OUTPUT_TIME_LENGTH);
+        return text + OUTPUT_TIME_LENGTH;
+    }
+
+    atsim_time_t time = sim_ClockToTime(clock);
+    text = write_number(text, time.hour, 2);
+    *text++ = ':';
+    return write_number(text, time.minute, 2);
+}
+
+/**
+ * @brief   Writes a null terminated string.
+ * @param   [out] text: char*
+ *                      -- Where the string is written.
+ * @param   [in] string: const char*
+ *                       -- String to write, without its null termination.
+ * @return  char*
+ *          -- Position after the string.
+ */
+static inline char* write_string(char *text, const char *string)
+{
+    while (*string != '\0') {
+        *text++ = *string++;
+    }
+
+    return text;
+}
+
+/**
+ * @brief   Initializes an output.
+ * @param   [out] output: output_t*
+ *                        -- Pointer to an output data type.
+ * @param   [in] fd: int
+ *                   -- File descriptor the output is written to.
+ * @param   [in] capacity: size_t
+ *                         -- Size of the output's buffer.
+ * @param   [in] day_times: bool
+ *                          -- Whether times are qualified with their day.
+ * @return  bool
+ *          -- True if the output was initialized, False if its buffer
+ *             couldn't be allocated.
+ */
+bool init_output(output_t *output, int fd, size_t capacity, bool day_times)
+{
+    if (!time_table_ready) {
+        for (uint32_t clock = 0; clock < OUTPUT_TIME_TABLE_SIZE; clock++) {
+            char *text = write_number(time_table[clock], clock / 60, 2);
+            *text = ':';
+            write_number(text + 1, clock % 60, 2);
+        }
+
+        time_table_ready = true;
+    }
+
+    capacity = (capacity < OUTPUT_LINE_MAX) ? OUTPUT_LINE_MAX : capacity;
+
+    output->buffer    = malloc(capacity);
+    output->length    = 0;
+    output->capacity  = (output->buffer != NULL) ? capacity : 0;
+    output->fd        = fd;
+    output->failed    = false;
+    output->day_times = day_times;
+
+    return (output->buffer != NULL);
+}
+
+/**
+ * @brief   Deinitializes an output, flushing and releasing its buffer.
+ * @param   [out] output: output_t*
+ *                        -- Pointer to an output data type.
+ * @return  bool
+ *          -- True if everything written to the output made it out.
+ */
+bool deinit_output(output_t *output)
+{
+    bool flushed = output_flush(output);
+
+    free(output->buffer);
+    output->buffer   = NULL;
+    output->capacity = 0;
+
+    return flushed;
+}
+
+/**
+ * @brief   Points an output at another file, keeping its buffer.
+ * @param   [out] output: output_t*
+ *                        -- Pointer to a flushed output data type.
+ * @param   [in] fd: int
+ *                   -- File descriptor the output is written to from now on.
+ * @details Failures writing to the previous file are forgotten.
+ */
+void output_redirect(output_t *output, int fd)
+{
+    output->length = 0;
+    output->fd     = fd;
+    output->failed = false;
+}
+
+/**
+ * @brief   Writes out everything in the output's buffer.
+ * @param   [in, out] output: output_t*
+ *                            -- Pointer to an output data type.
+ * @details After a failed write the output drops anything else written to
+ *          it, so the failure is only reported once.
+ * @return  bool
+ *          -- True if every write so far succeeded.
+ */
+bool output_flush(output_t *output)
+{
+    size_t written = 0;
+
+    while (!output->failed && written < output->length) {
+        ssize_t bytes = write(output->fd, output->buffer + written,
+                              output->length - written);
+
+        if (bytes >= 0) {
+            written += bytes;
+        }
+        else if (errno != EINTR) {
+            perror("atsim: writing the results");
+            output->failed = true;
+        }
+    }
+
+    output->length = 0;
+    return !output->failed;
+}
+
+/**
+ * @brief   Writes a line of formatted text to the output.
+ * @param   [in, out] output: output_t*
+ *                            -- Output the text is written to.
+ * @param   [in] format: const char*
+ *                       -- printf format of the line, which is cut short at
+ *                          OUTPUT_LINE_MAX characters.
+ */
+void output_text(output_t *output, const char *format, ...)
+{
+    va_list args;
+
+    if (output->capacity - output->length < OUTPUT_LINE_MAX) {
+        output_flush(output);
+    }
+
+    va_start(args, format);
+    int length = vsnprintf(output->buffer + output->length, OUTPUT_LINE_MAX,
+                           format, args);
+    va_end(args);
+
+    // An encoding error writes nothing, and a line that's cut short only
+    // keeps what fit.
+    if (length < 0) {
+        return;
+    }
+
+    output->length += ((size_t)length < OUTPUT_LINE_MAX) ?
+            (size_t)length : OUTPUT_LINE_MAX - 1;
+}
+
+/**
+ * @brief   Outputs the flight log once the flight has finished it's progression.
+ * @param   [in, out] output: output_t*
+ *                            -- Output the log is written to.
+ * @param   [in] flight: const flight_t *
+ *                       -- Pointer to the flight element to be logged.
+ * @param   [in] info: const flight_info_t *
+ *                     -- Pointer to the flight's carrier and number.
+ * @param   [in] origin: const airport_t *
+ *                       -- Pointer to the airport the flight departed from.
+ * @param   [in] destination: const airport_t *
+ *                            -- Pointer to the airport the flight landed at.
+ * @details Writes the same line as:
+ *          printf("[%02d:%02d] %s %d from %s to %s, departed %02d:%02d,
+ *          delay %d.\n", ...)
+ */
+void output_flight_log(output_t *output, const flight_t *flight,
+                       const flight_info_t *info, const airport_t *origin,
+                       const airport_t *destination)
+{
+    uint32_t delay = flight->time.arrival - flight->time.scheduled
+                     - flight->time.flight - 2*TAXI_DURATION;
+
+    if (output->capacity - output->length < OUTPUT_LINE_MAX) {
+        output_flush(output);
+    }
+
+    char *text = output->buffer + output->length;
+
+    *text++ = '[';
+    text = write_time(output, text, flight->time.arrival);
+    *text++ = ']';
+    *text++ = ' ';
+    text = write_string(text, info->carrier);
+    *text++ = ' ';
+    text = write_number(text, info->number, 1);
+    text = write_string(text, " from ");
+    text = write_string(text, origin->code);
+    text = write_string(text, " to ");
+    text = write_string(text, destination->code);
+    text = write_string(text, ", departed ");
+    text = write_time(output, text, flight->time.scheduled);
+    text = write_string(text, ", delay ");
+    text = write_number(text, delay, 1);
+    *text++ = '.';
+    *text++ = '\n';
+
+    output->length = text - output->buffer;
+}
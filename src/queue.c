@@ -6,73 +6,195 @@
  *          and manage the flight queue used in the simulation.
  */
 
+#include <stdlib.h>
 #include "queue.h"
 
+/**
+ * @brief   Allocates the buffer of a flight queue or mailbox.
+ * @param   [in] capacity: uint32_t
+ *                         -- Number of flights the buffer must be able to
+ *                            hold.
+ * @param   [out] mask: uint32_t*
+ *                      -- Set to the size of the buffer minus one.
+ * @details The buffer is sized to the smallest power of 2 that fits the
+ *          capacity, and every slot is marked as free for the position that
+ *          will first use it.
+ * @return  flight_queue_slot_t*
+ *          -- The buffer, or NULL if it couldn't be allocated.
+ */
+static flight_queue_slot_t* init_slots(uint32_t capacity, uint32_t *mask)
+{
+    uint32_t slots = 1;
+
+    while (slots < capacity && slots < (1u << 31)) {
+        slots <<= 1;
+    }
+
+    flight_queue_slot_t *buffer = malloc(slots * sizeof(flight_queue_slot_t));
+    *mask = slots - 1;
+
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < slots; i++) {
+        atomic_init(&buffer[i].sequence, i);
+        buffer[i].flight = FLIGHT_NONE;
+    }
+
+    return buffer;
+}
+
+/**
+ * @brief   Reserves a position at the tail of a ring and publishes a flight
+ *          into its slot.
+ * @param   [in, out] tail: _Atomic uint32_t*
+ *                          -- Tail of the ring.
+ * @param   [in] mask: uint32_t
+ *                     -- Size of the ring's buffer minus one.
+ * @param   [in, out] buffer: flight_queue_slot_t*
+ *                            -- Buffer of the ring.
+ * @param   [in] flight: uint32_t
+ *                       -- Index of the flight in its store.
+ * @details A producer reserves a position by moving the tail forward once it
+ *          sees the slot for that position is free, and then publishes the
+ *          flight by moving the slot's sequence forward.
+ * @return  bool
+ *          -- True if the flight was queued, False if the ring is full.
+ */
+static inline bool ring_enqueue(_Atomic uint32_t *tail, uint32_t mask,
+                                flight_queue_slot_t *buffer, uint32_t flight)
+{
+    flight_queue_slot_t *slot;
+    uint32_t pos = atomic_load_explicit(tail, memory_order_relaxed);
+
+    while (true) {
+        slot = &buffer[pos & mask];
+        uint32_t seq = atomic_load_explicit(&slot->sequence,
+                                            memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                    tail, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            // The consumer hasn't freed this slot yet, so the ring is full.
+            return false;
+        }
+        else {
+            // Another producer took this position first.
+            pos = atomic_load_explicit(tail, memory_order_relaxed);
+        }
+    }
+
+    slot->flight = flight;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief   Takes the flight at the head of a ring out of it.
+ * @param   [in, out] head: _Atomic uint32_t*
+ *                          -- Head of the ring.
+ * @param   [in] mask: uint32_t
+ *                     -- Size of the ring's buffer minus one.
+ * @param   [in, out] buffer: flight_queue_slot_t*
+ *                            -- Buffer of the ring.
+ * @details Once the flight is taken the slot is handed back to the producers
+ *          for the position one lap of the buffer ahead.
+ * @return  uint32_t
+ *          -- Index of the flight, or FLIGHT_NONE if the ring is empty.
+ */
+static inline uint32_t ring_pop(_Atomic uint32_t *head, uint32_t mask,
+                                flight_queue_slot_t *buffer)
+{
+    uint32_t pos = atomic_load_explicit(head, memory_order_relaxed);
+    flight_queue_slot_t *slot = &buffer[pos & mask];
+    uint32_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+    if (seq != pos + 1) {
+        return FLIGHT_NONE;
+    }
+
+    uint32_t flight = slot->flight;
+    atomic_store_explicit(&slot->sequence, pos + mask + 1,
+                          memory_order_release);
+    atomic_store_explicit(head, pos + 1, memory_order_release);
+
+    return flight;
+}
+
 /**
  * @brief   Initializes a flight queue.
  * @param   [out] queue: flight_queue_t*
  *                       -- Pointer to a flight queue data type.
+ * @param   [in] capacity: uint32_t
+ *                         -- Number of flights the queue must be able to hold.
  * @details This flight queue has been implemented as a circular buffer,
- *          which requires the head and tail pointers to be initializes to 0.
+ *          which requires the head and tail positions to be initialized to 0
+ *          along with its buffer.
+ * @return  int
+ *          -- 0 on success, -1 if the buffer couldn't be allocated.
  */
-int init_queue(flight_queue_t * queue)
+int init_queue(flight_queue_t * queue, uint32_t capacity)
 {
-    queue->tail = 0;
-    queue->head = 0;
-    return (pthread_mutex_init(&queue->mutex, NULL));
+    queue->buffer = init_slots(capacity, &queue->mask);
+
+    if (queue->buffer == NULL) {
+        return -1;
+    }
+
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    return 0;
 }
 
 /**
- * @brief   dequeues a flight from a flight queue.
+ * @brief   Deinitializes a flight queue, releasing its buffer.
  * @param   [out] queue: flight_queue_t*
  *                       -- Pointer to a flight queue data type.
- * @details Because the size of this circular buffer is static and a power of 2,
- *          dequeueing can be managed simply incrementing the head and
- *          masking it with the size of the queue, which prevents the head from
- *          ever pointing outside of the queue.
  */
-void dequeue(flight_queue_t *queue)
+void deinit_queue(flight_queue_t *queue)
 {
-    pthread_mutex_lock(&queue->mutex);
-    queue->head++;
-    queue->head &= FLIGHT_QUEUE_SIZE_MASK;
-    pthread_mutex_unlock(&queue->mutex);
+    free(queue->buffer);
+    queue->buffer = NULL;
+    queue->mask = 0;
 }
 
 /**
- * @brief   enqueues a flight from a flight queue.
+ * @brief   enqueues a flight into a flight queue.
  * @param   [out] queue: flight_queue_t*
  *                       -- Pointer to a flight queue data type.
- * @param   [in] flight: flight_t*
- *                       -- pointer to a flight data type.
- * @details Because the size of this circular buffer is static and a power of 2,
- *          enqueueing can be managed simply incrementing the tail and
- *          masking it with the size of the queue, which prevents the tail from
- *          ever pointing outside of the queue.
+ * @param   [in] flight: uint32_t
+ *                       -- Index of the flight in its store.
+ * @details The head and tail are free running positions, and because the size
+ *          of this circular buffer is a power of 2 they can be masked with
+ *          the size of the queue to find their slot.
+ * @return  bool
+ *          -- True if the flight was queued, False if the queue is full.
  */
-void enqueue(flight_queue_t *queue, flight_t *flight)
+bool enqueue(flight_queue_t *queue, uint32_t flight)
 {
-    pthread_mutex_lock(&queue->mutex);
-    queue->buffer[queue->tail] = flight;
-    queue->tail++;
-    queue->tail &= FLIGHT_QUEUE_SIZE_MASK;
-    pthread_mutex_unlock(&queue->mutex);
+    return ring_enqueue(&queue->tail, queue->mask, queue->buffer, flight);
 }
 
 /**
- * @brief   peeks at the element in from of a flight queue.
- * @param   [in] queue: flight_queue_t*
- *                      -- Pointer to a flight queue data type.
- * @return  flight_t*
- *          -- pointer to the flight element in front of the queue.
+ * @brief   Takes the flight in front of a flight queue out of it.
+ * @param   [in, out] queue: flight_queue_t*
+ *                           -- Pointer to a flight queue data type.
+ * @details Only the owner of the queue may call this, which is why the head
+ *          can be moved forward without contending with anyone.
+ * @return  uint32_t
+ *          -- Index of the flight that was in front of the queue,
+ *             or FLIGHT_NONE if the queue is empty.
  */
-flight_t* peek(flight_queue_t *queue)
+uint32_t try_pop(flight_queue_t *queue)
 {
-    pthread_mutex_lock(&queue->mutex);
-    flight_t *flight = queue->buffer[queue->head];
-    pthread_mutex_unlock(&queue->mutex);
-
-    return flight;
+    return ring_pop(&queue->head, queue->mask, queue->buffer);
 }
 
 /**
@@ -80,17 +202,129 @@ flight_t* peek(flight_queue_t *queue)
  * @param   [in] queue: flight_queue_t *
  *                      -- Pointer to a flight queue data type.
  * @details Finding the length of the queue is done by finding the distance
- *          between the head and the tail, and masking it with the size of
- *          the buffer, which accounts for when the tail has circled through
+ *          between the head and the tail. Both are free running, so the
+ *          distance stays correct when the tail has circled through
  *          the buffer.
+ *          Positions reserved by producers that are still writing their
+ *          flight are counted as well.
  * @return  uint32_t
  *          -- size of the queue.
  */
 uint32_t size(flight_queue_t * queue)
 {
-    pthread_mutex_lock(&queue->mutex);
-    uint32_t size = ((queue->tail - queue->head) & FLIGHT_QUEUE_SIZE_MASK);
-    pthread_mutex_unlock(&queue->mutex);
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    return (tail - head);
+}
+
+/**
+ * @brief   Looks at a flight in a flight queue without taking it out.
+ * @param   [in] queue: flight_queue_t *
+ *                      -- Pointer to a flight queue data type.
+ * @param   [in] index: uint32_t
+ *                      -- Place of the flight in the queue, 0 being the front.
+ * @details Only meant for when nobody is using the queue, such as between
+ *          clock ticks.
+ * @return  uint32_t
+ *          -- Index of the flight, or FLIGHT_NONE if the queue is shorter
+ *             than that.
+ */
+uint32_t peek_queue(flight_queue_t *queue, uint32_t index)
+{
+    if (index >= size(queue)) {
+        return FLIGHT_NONE;
+    }
+
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    return queue->buffer[(head + index) & queue->mask].flight;
+}
 
-    return size;
-}
\ No newline at end of file
+/**
+ * @brief   Initializes a flight mailbox.
+ * @param   [out] mailbox: flight_mailbox_t*
+ *                         -- Pointer to a flight mailbox data type.
+ * @param   [in] capacity: uint32_t
+ *                         -- Number of flights the mailbox must be able to
+ *                            hold.
+ * @details The mailbox is initialized like a flight queue, with the mask and
+ *          the buffer copied next to the tail for the producers.
+ * @return  int
+ *          -- 0 on success, -1 if the buffer couldn't be allocated.
+ */
+int init_mailbox(flight_mailbox_t *mailbox, uint32_t capacity)
+{
+    mailbox->buffer = init_slots(capacity, &mailbox->mask);
+    mailbox->tail_buffer = mailbox->buffer;
+    mailbox->tail_mask = mailbox->mask;
+
+    if (mailbox->buffer == NULL) {
+        return -1;
+    }
+
+    atomic_init(&mailbox->head, 0);
+    atomic_init(&mailbox->tail, 0);
+    return 0;
+}
+
+/**
+ * @brief   Deinitializes a flight mailbox, releasing its buffer.
+ * @param   [out] mailbox: flight_mailbox_t*
+ *                         -- Pointer to a flight mailbox data type.
+ */
+void deinit_mailbox(flight_mailbox_t *mailbox)
+{
+    free(mailbox->buffer);
+    mailbox->buffer = NULL;
+    mailbox->tail_buffer = NULL;
+    mailbox->mask = 0;
+    mailbox->tail_mask = 0;
+}
+
+/**
+ * @brief   enqueues a flight into a flight mailbox.
+ * @param   [out] mailbox: flight_mailbox_t*
+ *                         -- Pointer to a flight mailbox data type.
+ * @param   [in] flight: uint32_t
+ *                       -- Index of the flight in its store.
+ * @details Producers only read the tail's cache line, besides the slot they
+ *          write the flight to.
+ * @return  bool
+ *          -- True if the flight was queued, False if the mailbox is full.
+ */
+bool mailbox_enqueue(flight_mailbox_t *mailbox, uint32_t flight)
+{
+    return ring_enqueue(&mailbox->tail, mailbox->tail_mask,
+                        mailbox->tail_buffer, flight);
+}
+
+/**
+ * @brief   Takes the flight in front of a flight mailbox out of it.
+ * @param   [in, out] mailbox: flight_mailbox_t*
+ *                             -- Pointer to a flight mailbox data type.
+ * @details Only the owner of the mailbox may call this, and it only reads
+ *          the head's cache line, besides the slot it takes the flight from.
+ * @return  uint32_t
+ *          -- Index of the flight that was in front of the mailbox,
+ *             or FLIGHT_NONE if the mailbox is empty.
+ */
+uint32_t mailbox_try_pop(flight_mailbox_t *mailbox)
+{
+    return ring_pop(&mailbox->head, mailbox->mask, mailbox->buffer);
+}
+
+/**
+ * @brief   finds the size of a flight mailbox.
+ * @param   [in] mailbox: flight_mailbox_t *
+ *                        -- Pointer to a flight mailbox data type.
+ * @details Counts the same way the size of a flight queue is found.
+ * @return  uint32_t
+ *          -- size of the mailbox.
+ */
+uint32_t mailbox_size(flight_mailbox_t *mailbox)
+{
+    uint32_t tail = atomic_load_explicit(&mailbox->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&mailbox->head, memory_order_acquire);
+
+    return (tail - head);
+}
@@ -0,0 +1,862 @@
+/**
+ * @file    schedule.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that build the
+ *          simulation's schedule from the input: the flight, airport and
+ *          plane stores and the parsing of each flight.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "schedule.h"
+#include "sort.h"
+
+static const char IN_END[] = "end";
+
+/**
+ * @brief   Initializes the flight, airport and plane stores.
+ * @param   [out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the stores of the simulation.
+ * @param   [in] flights: uint32_t
+ *          -- Number of flights the simulation is expected to hold.
+ * @param   [in] airports: uint32_t
+ *          -- Number of airports the simulation is expected to hold.
+ * @param   [in] planes: uint32_t
+ *          -- Number of planes the simulation is expected to hold.
+ * @return  bool
+ *          -- True if the stores were initialized, False if the flight
+ *             store or the airport index couldn't be allocated.
+ */
+bool init_stores(simulation_param_t *sim_param, uint32_t flights,
+                 uint32_t airports, uint32_t planes)
+{
+    init_arena(&sim_param->airports, sizeof(airport_t), airports);
+    init_arena(&sim_param->planes, sizeof(plane_t), planes);
+
+    sim_param->flight_count    = 0;
+    sim_param->flight_capacity = (flights > 0) ? flights : 1;
+    sim_param->flights = malloc((size_t)sim_param->flight_capacity *
+                                sizeof(flight_t));
+    sim_param->flight_info = malloc((size_t)sim_param->flight_capacity *
+                                    sizeof(flight_info_t));
+    sim_param->plane_workers   = NULL;
+    sim_param->plane_takeoffs  = NULL;
+    sim_param->runway_airports = NULL;
+    sim_param->runway_metrics  = NULL;
+    sim_param->runway_count    = 0;
+    sim_param->events.heap     = NULL;
+    sim_param->events.count    = 0;
+    sim_param->events.capacity = 0;
+
+    sim_param->completed          = NULL;
+    sim_param->completed_count    = 0;
+    sim_param->completed_capacity = 0;
+
+    // The workers only get their events, runways and inboxes once the
+    // simulation knows how many airports each of them owns.
+    memset(sim_param->workers, 0, sizeof(sim_param->workers));
+
+    airport_index_t *index = &sim_param->airport_index;
+    index->direct        = calloc(AIRPORT_DIRECT_SIZE, sizeof(uint32_t));
+    index->hash_keys     = NULL;
+    index->hash_airports = NULL;
+    index->hash_mask     = 0;
+    index->hash_count    = 0;
+
+    return (sim_param->flights != NULL && sim_param->flight_info != NULL &&
+            index->direct != NULL);
+}
+
+/**
+ * @brief   Deinitializes the simulation's stores, releasing their memory.
+ * @param   [out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the stores of the simulation.
+ */
+void deinit_stores(simulation_param_t *sim_param)
+{
+    deinit_arena(&sim_param->airports);
+    deinit_arena(&sim_param->planes);
+    deinit_event_queue(&sim_param->events);
+
+    for (int i = 0; i < WORKER_MAX_COUNT; i++) {
+        worker_t *worker = &sim_param->workers[i];
+
+        deinit_event_queue(&worker->events);
+        deinit_event_queue(&worker->departed);
+        deinit_mailbox(&worker->inbox);
+        deinit_mailbox(&worker->takeoffs);
+        free(worker->due);
+        free(worker->runways);
+        free(worker->completed);
+        worker->due                = NULL;
+        worker->runways            = NULL;
+        worker->completed          = NULL;
+        worker->completed_capacity = 0;
+    }
+
+    free(sim_param->flights);
+    free(sim_param->flight_info);
+    free(sim_param->plane_workers);
+    free(sim_param->plane_takeoffs);
+    free(sim_param->runway_airports);
+    free(sim_param->runway_metrics);
+    free(sim_param->completed);
+    free(sim_param->airport_index.direct);
+    free(sim_param->airport_index.hash_keys);
+    free(sim_param->airport_index.hash_airports);
+    memset(&sim_param->airport_index, 0, sizeof(airport_index_t));
+
+    sim_param->flights         = NULL;
+    sim_param->flight_info     = NULL;
+    sim_param->plane_workers   = NULL;
+    sim_param->plane_takeoffs  = NULL;
+    sim_param->runway_airports = NULL;
+    sim_param->runway_metrics  = NULL;
+    sim_param->completed       = NULL;
+    sim_param->flight_count    = 0;
+    sim_param->flight_capacity = 0;
+}
+
+/**
+ * @brief   Empties the flight, airport and plane stores so another schedule
+ *          can be read into them.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the stores of the simulation.
+ * @details Everything the stores took so far is kept, so reading schedules
+ *          of similar sizes one after another doesn't allocate again.
+ */
+void reset_stores(simulation_param_t *sim_param)
+{
+    airport_index_t *index = &sim_param->airport_index;
+
+    arena_reset(&sim_param->airports);
+    arena_reset(&sim_param->planes);
+
+    memset(index->direct, 0, AIRPORT_DIRECT_SIZE * sizeof(uint32_t));
+
+    if (index->hash_mask > 0) {
+        memset(index->hash_keys, 0, (index->hash_mask + 1) * sizeof(uint32_t));
+        memset(index->hash_airports, 0,
+               (index->hash_mask + 1) * sizeof(uint32_t));
+    }
+
+    index->hash_count           = 0;
+    sim_param->flight_count     = 0;
+    sim_param->runway_count     = 0;
+    sim_param->completed_count  = 0;
+}
+
+/**
+ * @brief   Copies a schedule into empty stores.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the stores of the simulation, which have to be empty.
+ * @param   [in] source: const simulation_param_t*
+ *          -- Pointer to the simulation holding the schedule, which is only
+ *             read from.
+ * @details Airports, planes and flights keep their indices, so whatever
+ *          refers to them by index is copied as is. Only what the schedule
+ *          itself fills in is copied, not the airport index.
+ * @return  bool
+ *          -- True if the schedule was copied, False if the stores couldn't
+ *             grow.
+ */
+bool copy_schedule(simulation_param_t *sim_param,
+                   const simulation_param_t *source)
+{
+    uint32_t count = source->flight_count;
+
+    if (count > sim_param->flight_capacity &&
+        !grow_flights(sim_param, count)) {
+        return false;
+    }
+
+    if (!arena_grow(&sim_param->airports, source->airports.count) ||
+        !arena_grow(&sim_param->planes, source->planes.count)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < source->airports.count; i++) {
+        const airport_t *from = AIRPORT(source, i);
+        airport_t *airport = AIRPORT(sim_param, i);
+
+        memcpy(airport->code, from->code, CODE_STR_SIZE);
+        airport->id              = from->id;
+        airport->departure_count = from->departure_count;
+        airport->arrival_count   = from->arrival_count;
+    }
+
+    for (uint32_t i = 0; i < source->planes.count; i++) {
+        const plane_t *from = PLANE(source, i);
+        plane_t *plane = PLANE(sim_param, i);
+
+        plane->id       = from->id;
+        plane->airport  = from->airport;
+        plane->ready_at = from->ready_at;
+        plane->waiting  = FLIGHT_NONE;
+    }
+
+    memcpy(sim_param->flights, source->flights,
+           (size_t)count * sizeof(flight_t));
+    memcpy(sim_param->flight_info, source->flight_info,
+           (size_t)count * sizeof(flight_info_t));
+
+    sim_param->flight_count = count;
+    return true;
+}
+
+/**
+ * @brief   Grows every column of the flight store.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the flight store.
+ * @param   [in] capacity: uint32_t
+ *          -- Number of flights the store must be able to hold.
+ * @details A column that grew stays grown if another one couldn't, which
+ *          is harmless as the capacity only covers what every column holds.
+ * @return  bool
+ *          -- True if the store grew, False if memory ran out.
+ */
+bool grow_flights(simulation_param_t *sim_param, uint32_t capacity)
+{
+    flight_t *flights = realloc(sim_param->flights,
+                                (size_t)capacity * sizeof(flight_t));
+
+    if (flights == NULL) {
+        return false;
+    }
+
+    sim_param->flights = flights;
+
+    flight_info_t *info = realloc(sim_param->flight_info,
+                                  (size_t)capacity * sizeof(flight_info_t));
+
+    if (info == NULL) {
+        return false;
+    }
+
+    sim_param->flight_info = info;
+    sim_param->flight_capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief   Adds a flight to the end of the flight store.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Uses and alters the flight store.
+ * @details The store doubles in size whenever it's full.
+ * @return  uint32_t
+ *          -- Index of the new zeroed flight, or FLIGHT_NONE if the store
+ *             couldn't grow.
+ */
+uint32_t add_flight(simulation_param_t *sim_param)
+{
+    if (sim_param->flight_count == sim_param->flight_capacity) {
+        uint32_t capacity = (sim_param->flight_capacity >= FLIGHT_NONE / 2) ?
+                FLIGHT_NONE : sim_param->flight_capacity * 2;
+
+        if (capacity == sim_param->flight_count ||
+            !grow_flights(sim_param, capacity)) {
+            return FLIGHT_NONE;
+        }
+    }
+
+    uint32_t index = sim_param->flight_count++;
+
+    memset(&sim_param->flights[index], 0, sizeof(flight_t));
+    memset(&sim_param->flight_info[index], 0, sizeof(flight_info_t));
+    return index;
+}
+
+/**
+ * @brief   Adds a flight to the schedule.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the flight store, the plane the flight uses and the
+ *             airports it goes through.
+ * @param   [in] entry: const flight_t*
+ *          -- Flight to add, with its plane, airports, scheduled time and
+ *             duration filled in.
+ * @param   [in] carrier: const char*
+ *          -- Carrier code of the flight.
+ * @param   [in] number: uint16_t
+ *          -- Flight number.
+ * @details A plane starts off at the origin of the first flight that uses it.
+ *          The flight's taxis and its plane's grooming take their nominal
+ *          durations.
+ * @return  flight_t*
+ *          -- Pointer to the added flight, or NULL if the store couldn't grow.
+ */
+flight_t* insert_flight(simulation_param_t *sim_param, const flight_t *entry,
+                        const char *carrier, uint16_t number)
+{
+    uint32_t index = add_flight(sim_param);
+
+    if (index == FLIGHT_NONE) {
+        return NULL;
+    }
+
+    flight_t *flight = &sim_param->flights[index];
+    flight_info_t *info = &sim_param->flight_info[index];
+    plane_t *plane = PLANE(sim_param, entry->plane);
+
+    memcpy(info->carrier, carrier, CARRIER_ID_STR_SIZE);
+    info->number             = number;
+    info->next_waiting       = FLIGHT_NONE;
+    flight->plane            = entry->plane;
+    flight->origin           = entry->origin;
+    flight->destination      = entry->destination;
+    flight->time.scheduled   = entry->time.scheduled;
+    flight->time.flight      = entry->time.flight;
+    flight->taxi_out         = TAXI_DURATION;
+    flight->taxi_in          = TAXI_DURATION;
+    flight->groom            = PLANE_GROOM_DURATION;
+
+    if (plane->airport == PLANE_ON_AIR) {
+        plane->airport = flight->origin;
+    }
+
+    // Each airport's queues are sized to the flights that go through it.
+    AIRPORT(sim_param, flight->origin)->departure_count++;
+    AIRPORT(sim_param, flight->destination)->arrival_count++;
+
+    // Set the simulation clock to start at the first departure of the
+    // simulation, as to avoid needless loops of the program.
+    sim_param->clock = (flight->time.scheduled < sim_param->clock) ?
+                 flight->time.scheduled : sim_param->clock;
+    return flight;
+}
+
+/**
+ * @brief   Finds the plane with a given ID, growing the plane store if the
+ *          plane hasn't been seen yet.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Uses and alters the plane store.
+ * @param   [in] id: uint32_t
+ *          -- Plane ID.
+ * @details Planes the store grows by start off nowhere, with no flights
+ *          waiting on them.
+ * @return  plane_t*
+ *          -- Pointer to the plane, or NULL if the store couldn't grow.
+ */
+plane_t* find_plane(simulation_param_t *sim_param, uint32_t id)
+{
+    uint32_t count = sim_param->planes.count;
+
+    if (id >= count) {
+        if (!arena_grow(&sim_param->planes, id + 1)) {
+            return NULL;
+        }
+
+        for (uint32_t i = count; i <= id; i++) {
+            plane_t *plane = PLANE(sim_param, i);
+
+            plane->id      = i;
+            plane->airport = PLANE_ON_AIR;
+            plane->waiting = FLIGHT_NONE;
+        }
+    }
+
+    return PLANE(sim_param, id);
+}
+
+/**
+ * @brief   Packs an airport code into an integer.
+ * @param   [in] code: const char*
+ *          -- Airport code.
+ * @details Only the characters up to the code's null termination are packed,
+ *          one per byte.
+ * @return  uint32_t
+ *          -- Packed code, never 0 for a code with at least one character.
+ */
+static uint32_t pack_code(const char *code)
+{
+    uint32_t key = 0;
+
+    for (int i = 0; i < CODE_LENGTH && code[i] != '\0'; i++) {
+        key |= (uint32_t)(uint8_t)code[i] << (8 * i);
+    }
+
+    return key;
+}
+
+/**
+ * @brief   Finds the direct table entry of an airport code.
+ * @param   [in] code: const char*
+ *          -- Airport code.
+ * @return  uint32_t
+ *          -- Entry of the code, or AIRPORT_DIRECT_SIZE if the code isn't
+ *             made of three uppercase letters.
+ */
+static uint32_t direct_entry(const char *code)
+{
+    uint32_t entry = 0;
+
+    for (int i = 0; i < CODE_LENGTH; i++) {
+        uint32_t letter = (uint8_t)code[i] - 'A';
+
+        if (letter >= AIRPORT_CODE_LETTERS) {
+            return AIRPORT_DIRECT_SIZE;
+        }
+
+        entry = entry * AIRPORT_CODE_LETTERS + letter;
+    }
+
+    return (code[CODE_LENGTH] == '\0') ? entry : AIRPORT_DIRECT_SIZE;
+}
+
+/**
+ * @brief   Finds the hash table entry of a packed airport code.
+ * @param   [in, out] index: airport_index_t*
+ *          -- Pointer to the airport index.
+ * @param   [in] key: uint32_t
+ *          -- Packed airport code.
+ * @details The table is grown to keep it at most half full, so there's
+ *          always a free entry to stop the probing.
+ * @return  uint32_t*
+ *          -- Pointer to the entry of the code, which is 0 if the code isn't
+ *             in the table yet, or NULL if the table couldn't grow.
+ */
+static uint32_t* hash_entry(airport_index_t *index, uint32_t key)
+{
+    if (2 * (index->hash_count + 1) > index->hash_mask + 1) {
+        uint32_t size = (index->hash_mask > 0) ?
+                2 * (index->hash_mask + 1) : AIRPORT_HASH_MIN_SIZE;
+        uint32_t *keys = calloc(size, sizeof(uint32_t));
+        uint32_t *airports = calloc(size, sizeof(uint32_t));
+
+        if (keys == NULL || airports == NULL) {
+            free(keys);
+            free(airports);
+            return NULL;
+        }
+
+        for (uint32_t i = 0; index->hash_mask > 0 && i <= index->hash_mask;
+             i++) {
+            if (index->hash_airports[i] != 0) {
+                uint32_t slot = (index->hash_keys[i] * 2654435761u) &
+                                (size - 1);
+
+                while (airports[slot] != 0) {
+                    slot = (slot + 1) & (size - 1);
+                }
+
+                keys[slot] = index->hash_keys[i];
+                airports[slot] = index->hash_airports[i];
+            }
+        }
+
+        free(index->hash_keys);
+        free(index->hash_airports);
+        index->hash_keys = keys;
+        index->hash_airports = airports;
+        index->hash_mask = size - 1;
+    }
+
+    uint32_t slot = (key * 2654435761u) & index->hash_mask;
+
+    while (index->hash_airports[slot] != 0 && index->hash_keys[slot] != key) {
+        slot = (slot + 1) & index->hash_mask;
+    }
+
+    index->hash_keys[slot] = key;
+    return &index->hash_airports[slot];
+}
+
+/**
+ * @brief   Looks for an airport with a given code, and instantiates an airport
+ *          if not found.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Uses and alters the airport store and the airport index.
+ * @param   [in] code: const char*
+ *          -- Airport code.
+ * @details Codes of three uppercase letters index a table of every possible
+ *          code directly. Any other code is looked up in a hash table.
+ *          Either way the lookup takes constant time.
+ * @return  airport_t*
+ *          -- pointer to airport element with corresponding code,
+ *             or NULL if a new airport couldn't be allocated.
+ */
+airport_t* find_airport(simulation_param_t *sim_param, const char *code)
+{
+    airport_index_t *index = &sim_param->airport_index;
+    uint32_t direct = direct_entry(code);
+    uint32_t *entry;
+
+    if (direct < AIRPORT_DIRECT_SIZE) {
+        entry = &index->direct[direct];
+    }
+    else if ((entry = hash_entry(index, pack_code(code))) == NULL) {
+        return NULL;
+    }
+
+    if (*entry != 0) {
+        return AIRPORT(sim_param, *entry - 1);
+    }
+
+    airport_t *airport = arena_push(&sim_param->airports);
+
+    if (airport != NULL) {
+        memcpy(airport->code, code, CODE_STR_SIZE);
+        airport->id = sim_param->airports.count - 1;
+        *entry = sim_param->airports.count;
+        index->hash_count += (direct == AIRPORT_DIRECT_SIZE);
+    }
+
+    return airport;
+}
+
+/**
+ * @brief   Checks whether a character is whitespace, the way scanf does.
+ * @param   [in] c: char
+ *                  -- Character to check.
+ * @return  bool
+ *          -- True if the character is whitespace.
+ */
+static inline bool is_space(char c)
+{
+    return (c == ' ' || (c >= '\t' && c <= '\r'));
+}
+
+/**
+ * @brief   Skips the whitespace at the start of a field.
+ * @param   [in] data: const char*
+ *                     -- Current position in the line.
+ * @param   [in] end: const char*
+ *                    -- End of the line.
+ * @return  const char*
+ *          -- First character that isn't whitespace, or the end of the line.
+ */
+static inline const char* skip_space(const char *data, const char *end)
+{
+    while (data < end && is_space(*data)) {
+        data++;
+    }
+
+    return data;
+}
+
+/**
+ * @brief   Scans a string field, like scanf's %Ns conversion.
+ * @param   [in] data: const char*
+ *                     -- Current position in the line.
+ * @param   [in] end: const char*
+ *                    -- End of the line.
+ * @param   [out] field: char*
+ *                       -- Buffer of at least width + 1 characters that gets
+ *                          the field, null terminated.
+ * @param   [in] width: size_t
+ *                      -- Most characters the field can take.
+ * @return  const char*
+ *          -- Position after the field, or NULL if there was no field.
+ */
+static const char* scan_string(const char *data, const char *end,
+                               char *field, size_t width)
+{
+    size_t length = 0;
+    data = skip_space(data, end);
+
+    while (data < end && length < width && !is_space(*data)) {
+        field[length++] = *data++;
+    }
+
+    field[length] = '\0';
+    return (length > 0) ? data : NULL;
+}
+
+/**
+ * @brief   Scans a decimal field, like scanf's %d conversions.
+ * @param   [in] data: const char*
+ *                     -- Current position in the line.
+ * @param   [in] end: const char*
+ *                    -- End of the line.
+ * @param   [out] value: uint32_t*
+ *                       -- Gets the field's value. Negative values wrap
+ *                          around, so they can be truncated to any narrower
+ *                          unsigned type like scanf would.
+ * @return  const char*
+ *          -- Position after the field, or NULL if there was no number.
+ */
+static const char* scan_number(const char *data, const char *end,
+                               uint32_t *value)
+{
+    uint64_t number = 0;
+    bool negative = false;
+    data = skip_space(data, end);
+
+    if (data < end && (*data == '-' || *data == '+')) {
+        negative = (*data++ == '-');
+    }
+
+    const char *digits = data;
+
+    while (data < end && *data >= '0' && *data <= '9') {
+        number = number * 10 + (uint64_t)(*data++ - '0');
+
+        // Clamped so huge values still read as too large rather than wrap.
+        number = (number > UINT32_MAX) ? (uint64_t)UINT32_MAX + 1 : number;
+    }
+
+    *value = negative ? (uint32_t)(0 - number) :
+             (number > UINT32_MAX) ? UINT32_MAX : (uint32_t)number;
+    return (data > digits) ? data : NULL;
+}
+
+/**
+ * @brief   Configures the simulation parameters based on the input received
+ *          from the console.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Uses and alters every element in the simulation
+ *             parameters except state and complete flag.
+ * @param   [in] data: const char*
+ *          -- Line received from console, without its newline.
+ * @param   [in] length: size_t
+ *          -- Length of the line.
+ * @details The line is read field by field with the same rules as
+ *          sscanf(data, "%2s %hd %u %3s %hhd:%hhd %hd %3s"), but without
+ *          going through a format string for every flight.
+ *          The departure time can also be qualified with a day, as D:HH:MM,
+ *          where day 0 is the day the simulation starts on.
+ * @return  bool
+ *          -- False if the line isn't a flight, in which case it is ignored,
+ *             or if memory ran out, in which case errno is set to ENOMEM.
+ */
+bool configure_simulation_data(simulation_param_t *sim_param, const char *data,
+                               size_t length)
+{
+    char carrier[CARRIER_ID_STR_SIZE] = {0};
+    char origin_code[CODE_STR_SIZE] = {0}, dest_code[CODE_STR_SIZE] = {0};
+    uint32_t number, plane_id, day = 0, hour, minute, duration;
+    const char *end = data + length;
+
+    if ((data = scan_string(data, end, carrier, CARRIER_ID_LENGTH)) == NULL ||
+        (data = scan_number(data, end, &number)) == NULL ||
+        (data = scan_number(data, end, &plane_id)) == NULL ||
+        (data = scan_string(data, end, origin_code, CODE_LENGTH)) == NULL ||
+        (data = scan_number(data, end, &hour)) == NULL ||
+        data == end || *data++ != ':' ||
+        (data = scan_number(data, end, &minute)) == NULL) {
+        return false;
+    }
+
+    // A day qualified time reads D:HH:MM, so what was read is the day and hour.
+    if (data < end && *data == ':') {
+        day = hour;
+        hour = minute;
+
+        if ((data = scan_number(data + 1, end, &minute)) == NULL ||
+            day > SIMULATION_MAX_DAYS) {
+            return false;
+        }
+    }
+
+    if ((data = scan_number(data, end, &duration)) == NULL ||
+        (data = scan_string(data, end, dest_code, CODE_LENGTH)) == NULL) {
+        return false;
+    }
+
+    /*
+     * Other than for the format of each field, the console input isn't
+     * checked for invalid data on purpose.
+     * As this is simply a simulation of a system, it is the user's
+     * responsibility to input valid data into the program.
+     * The plane ID is the exception, as planes are stored by their ID.
+     */
+    if (plane_id > PLANE_ID_MAX) {
+        fprintf(stderr, "atsim: plane ID %u is over the maximum of %u, "
+                        "flight ignored\n", plane_id, PLANE_ID_MAX);
+        return true;
+    }
+
+    atsim_time_t time = {.day = (uint16_t)day, .hour = (uint8_t)hour,
+                         .minute = (uint8_t)minute};
+    airport_t *origin = find_airport(sim_param, origin_code);
+    airport_t *destination = find_airport(sim_param, dest_code);
+    plane_t *plane = find_plane(sim_param, plane_id);
+
+    if (origin == NULL || destination == NULL || plane == NULL) {
+        errno = ENOMEM;
+        return false;
+    }
+
+    flight_t entry = {
+            .origin      = origin->id,
+            .destination = destination->id,
+            .plane       = plane->id,
+            // The simulation time is converted into its equivalent clock value.
+            .time        = {.scheduled = sim_TimeToClock(time),
+                            .flight    = duration}
+    };
+
+    if (insert_flight(sim_param, &entry, carrier, (uint16_t)number) == NULL) {
+        errno = ENOMEM;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Reads the flights of the simulation up to the end command.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Gets every flight read.
+ * @param   [in] fd: int
+ *          -- File descriptor the schedule is read from.
+ * @details The input is read in large blocks and split into lines with
+ *          memchr, which is vectorized by the C library. Blank lines are
+ *          skipped, and lines that aren't flights are reported and ignored.
+ *          The end of the input counts as an end command.
+ * @return  bool
+ *          -- True if the schedule was read, False if reading failed or
+ *             memory ran out, with errno telling which.
+ */
+bool read_schedule(simulation_param_t *sim_param, int fd)
+{
+    char *buffer = malloc(SCHEDULE_READ_SIZE);
+    size_t filled = 0;
+    uint32_t line_number = 0;
+    bool done = false, skipping = false, success = (buffer != NULL);
+
+    while (success && !done) {
+        ssize_t bytes = read(fd, buffer + filled, SCHEDULE_READ_SIZE - filled);
+
+        if (bytes < 0) {
+            success = (errno == EINTR);
+            continue;
+        }
+
+        char *line = buffer, *end = buffer + filled + bytes, *newline;
+        bool at_eof = (bytes == 0);
+
+        while (!done && line < end) {
+            if ((newline = memchr(line, '\n', end - line)) == NULL) {
+                if (!at_eof) {
+                    break;
+                }
+
+                newline = end;
+            }
+
+            size_t length = newline - line;
+
+            // The rest of a line that didn't fit in the buffer is dropped.
+            if (!skipping) {
+                line_number++;
+
+                if (length >= sizeof(IN_END) - 1 &&
+                    !memcmp(line, IN_END, sizeof(IN_END) - 1)) {
+                    done = true;
+                }
+                else if (skip_space(line, newline) != newline) {
+                    errno = 0;
+                    bool flight = configure_simulation_data(sim_param, line,
+                                                            length);
+
+                    if (!flight && errno == ENOMEM) {
+                        success = false;
+                        done = true;
+                    }
+                    else if (!flight) {
+                        fprintf(stderr, "atsim: line %u is not a flight, "
+                                        "ignored\n", line_number);
+                    }
+                }
+            }
+
+            skipping = false;
+            line = (newline < end) ? newline + 1 : end;
+        }
+
+        filled = end - line;
+        memmove(buffer, line, filled);
+
+        // A line that fills the whole buffer can't be a flight.
+        if (filled == SCHEDULE_READ_SIZE) {
+            if (!skipping) {
+                fprintf(stderr, "atsim: line %u is not a flight, ignored\n",
+                        ++line_number);
+            }
+
+            skipping = true;
+            filled = 0;
+        }
+
+        done = done || at_eof;
+    }
+
+    free(buffer);
+    return success;
+}
+
+/**
+ * @brief   Sorts the flight elements in the simulation based on their
+ *          flight number.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Replaces the flight columns with sorted copies.
+ * @details The flight numbers are radix sorted into a permutation, and each
+ *          column is then copied once into a new array in that order.
+ *          The new arrays keep the old ones' capacity, so the store can take
+ *          another schedule of the same size without growing.
+ *          Flights with the same number keep their input order.
+ * @return  bool
+ *          -- True if the flights were sorted, False if memory ran out.
+ */
+bool sort_flights(simulation_param_t *sim_param)
+{
+    uint32_t count = sim_param->flight_count;
+
+    if (count < 2) {
+        return true;
+    }
+
+    uint64_t *keys = malloc((size_t)count * sizeof(uint64_t));
+    uint32_t *order = malloc((size_t)count * sizeof(uint32_t));
+    flight_t *sorted = malloc((size_t)sim_param->flight_capacity *
+                              sizeof(flight_t));
+    flight_info_t *sorted_info = malloc((size_t)sim_param->flight_capacity *
+                                        sizeof(flight_info_t));
+    bool done = (keys != NULL && order != NULL && sorted != NULL &&
+                 sorted_info != NULL);
+
+    if (done) {
+        for (uint32_t i = 0; i < count; i++) {
+            keys[i] = sim_param->flight_info[i].number;
+        }
+
+        done = sort_permutation(keys, order, count);
+    }
+
+    if (done) {
+        for (uint32_t i = 0; i < count; i++) {
+            sorted[i] = sim_param->flights[order[i]];
+            sorted_info[i] = sim_param->flight_info[order[i]];
+        }
+
+        free(sim_param->flights);
+        free(sim_param->flight_info);
+        sim_param->flights = sorted;
+        sim_param->flight_info = sorted_info;
+        sorted = NULL;
+        sorted_info = NULL;
+    }
+
+    free(keys);
+    free(order);
+    free(sorted);
+    free(sorted_info);
+    return done;
+}
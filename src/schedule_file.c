@@ -0,0 +1,304 @@
+/**
+ * @file    schedule_file.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that write a parsed
+ *          schedule to a compiled schedule file and load it back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "file.h"
+#include "schedule_file.h"
+#include "schedule.h"
+
+#define ALIGN_4(size)       (((size) + 3u) & ~(size_t)3u)
+#define CARRIER_KEY(code)   ((uint8_t)(code)[0] | ((uint8_t)(code)[1] << 8))
+#define CARRIER_KEYS        (1u << 16)
+
+/*
+ * Offset of each section from the start of the file.
+ */
+typedef struct {
+    size_t  airports;
+    size_t  carriers;
+    size_t  number;
+    size_t  carrier;
+    size_t  plane;
+    size_t  origin;
+    size_t  destination;
+    size_t  scheduled;
+    size_t  duration;
+    size_t  size;
+} schedule_layout_t;
+
+/**
+ * @brief   Works out where each section of a compiled schedule sits.
+ * @param   [in] header: const schedule_file_header_t*
+ *                       -- Header of the compiled schedule.
+ * @param   [out] layout: schedule_layout_t*
+ *                        -- Gets the offset of each section.
+ */
+static void schedule_layout(const schedule_file_header_t *header,
+                            schedule_layout_t *layout)
+{
+    size_t flights = header->flight_count;
+    size_t offset = sizeof(schedule_file_header_t);
+
+    layout->airports    = offset;
+    offset += (size_t)header->airport_count * SCHEDULE_FILE_CODE_SIZE;
+    layout->carriers    = offset;
+    offset += (size_t)header->carrier_count * SCHEDULE_FILE_CODE_SIZE;
+    layout->number      = offset;
+    offset += ALIGN_4(flights * sizeof(uint16_t));
+    layout->carrier     = offset;
+    offset += ALIGN_4(flights * sizeof(uint16_t));
+    layout->plane       = offset;
+    offset += flights * sizeof(uint32_t);
+    layout->origin      = offset;
+    offset += flights * sizeof(uint32_t);
+    layout->destination = offset;
+    offset += flights * sizeof(uint32_t);
+    layout->scheduled   = offset;
+    offset += flights * sizeof(uint32_t);
+    layout->duration    = offset;
+    offset += flights * sizeof(uint32_t);
+    layout->size        = offset;
+}
+
+/**
+ * @brief   Checks that a code from a compiled schedule is a valid string.
+ * @param   [in] code: const char*
+ *                     -- Code, SCHEDULE_FILE_CODE_SIZE characters long.
+ * @param   [in] length: size_t
+ *                       -- Most characters the code can have.
+ * @return  bool
+ *          -- True if the code has between 1 and length characters and is
+ *             padded with null characters.
+ */
+static bool valid_code(const char *code, size_t length)
+{
+    if (code[0] == '\0') {
+        return false;
+    }
+
+    for (size_t i = strnlen(code, SCHEDULE_FILE_CODE_SIZE);
+         i < SCHEDULE_FILE_CODE_SIZE; i++) {
+        if (code[i] != '\0') {
+            return false;
+        }
+    }
+
+    return (strnlen(code, SCHEDULE_FILE_CODE_SIZE) <= length);
+}
+
+/**
+ * @brief   Writes the schedule read so far to a compiled schedule file.
+ * @param   [in] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Only the schedule is used, which must not be sorted yet.
+ * @param   [in] path: const char*
+ *          -- Path of the file to write.
+ * @details Flights are kept in input order, so loading the file gives the
+ *          simulation the same stores reading the text schedule does.
+ * @return  bool
+ *          -- True if the file was written, False if not.
+ */
+bool write_schedule_file(simulation_param_t *sim_param, const char *path)
+{
+    schedule_file_header_t header = {
+            .magic         = SCHEDULE_FILE_MAGIC,
+            .version       = SCHEDULE_FILE_VERSION,
+            .flight_count  = sim_param->flight_count,
+            .airport_count = sim_param->airports.count
+    };
+    uint32_t *carrier_index = calloc(CARRIER_KEYS, sizeof(uint32_t));
+    char (*carriers)[SCHEDULE_FILE_CODE_SIZE] = calloc(CARRIER_KEYS,
+                                                       sizeof(*carriers));
+    uint16_t *flight_carrier = malloc((size_t)sim_param->flight_count *
+                                      sizeof(uint16_t) + 1);
+    schedule_layout_t layout;
+    uint8_t *data = NULL;
+    bool written = false;
+
+    if (carrier_index != NULL && carriers != NULL && flight_carrier != NULL) {
+        // Carriers are interned in the order they first show up in.
+        for (uint32_t i = 0; i < sim_param->flight_count; i++) {
+            const char *code = sim_param->flight_info[i].carrier;
+            uint32_t *entry = &carrier_index[CARRIER_KEY(code)];
+
+            if (*entry == 0) {
+                memcpy(carriers[header.carrier_count], code,
+                       CARRIER_ID_STR_SIZE);
+                *entry = ++header.carrier_count;
+            }
+
+            flight_carrier[i] = (uint16_t)(*entry - 1);
+        }
+
+        schedule_layout(&header, &layout);
+        data = calloc(1, layout.size);
+    }
+
+    if (data != NULL) {
+        uint16_t *number      = (uint16_t *)(data + layout.number);
+        uint32_t *plane       = (uint32_t *)(data + layout.plane);
+        uint32_t *origin      = (uint32_t *)(data + layout.origin);
+        uint32_t *destination = (uint32_t *)(data + layout.destination);
+        uint32_t *scheduled   = (uint32_t *)(data + layout.scheduled);
+        uint32_t *duration    = (uint32_t *)(data + layout.duration);
+
+        memcpy(data, &header, sizeof(header));
+        memcpy(data + layout.carriers, carriers,
+               (size_t)header.carrier_count * SCHEDULE_FILE_CODE_SIZE);
+        memcpy(data + layout.carrier, flight_carrier,
+               (size_t)header.flight_count * sizeof(uint16_t));
+
+        for (uint32_t i = 0; i < header.airport_count; i++) {
+            memcpy(data + layout.airports + (size_t)i * SCHEDULE_FILE_CODE_SIZE,
+                   AIRPORT(sim_param, i)->code, CODE_STR_SIZE);
+        }
+
+        for (uint32_t i = 0; i < header.flight_count; i++) {
+            flight_t *flight = &sim_param->flights[i];
+
+            number[i]      = sim_param->flight_info[i].number;
+            plane[i]       = flight->plane;
+            origin[i]      = flight->origin;
+            destination[i] = flight->destination;
+            scheduled[i]   = flight->time.scheduled;
+            duration[i]    = flight->time.flight;
+        }
+
+        written = write_file(path, data, layout.size);
+    }
+    else {
+        fprintf(stderr, "atsim: out of memory\n");
+    }
+
+    free(carrier_index);
+    free(carriers);
+    free(flight_carrier);
+    free(data);
+    return written;
+}
+
+/**
+ * @brief   Loads the schedule of the simulation from a compiled schedule file.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Gets every flight, airport and plane in the file.
+ * @param   [in] path: const char*
+ *          -- Path of the file to load.
+ * @details The file is mapped and its columns are read in place. Nothing is
+ *          parsed, though every index is checked before it's used.
+ * @return  bool
+ *          -- True if the schedule was loaded, False if the file couldn't be
+ *             read or isn't a valid compiled schedule.
+ */
+bool load_schedule_file(simulation_param_t *sim_param, const char *path)
+{
+    size_t file_size;
+    const uint8_t *data = map_file(path, &file_size);
+    const char *error = NULL;
+    schedule_file_header_t header;
+    schedule_layout_t layout;
+
+    if (data == NULL) {
+        return false;
+    }
+
+    if (file_size < sizeof(header)) {
+        error = "not a compiled schedule";
+    }
+    else {
+        memcpy(&header, data, sizeof(header));
+        schedule_layout(&header, &layout);
+
+        if (memcmp(header.magic, SCHEDULE_FILE_MAGIC, sizeof(header.magic))) {
+            error = "not a compiled schedule";
+        }
+        else if (header.version != SCHEDULE_FILE_VERSION) {
+            error = "unsupported compiled schedule version";
+        }
+        else if (layout.size != file_size) {
+            error = "truncated compiled schedule";
+        }
+    }
+
+    const char *carriers = (error == NULL) ?
+            (const char *)(data + layout.carriers) : NULL;
+
+    for (uint32_t i = 0; error == NULL && i < header.carrier_count; i++) {
+        if (!valid_code(&carriers[(size_t)i * SCHEDULE_FILE_CODE_SIZE],
+                        CARRIER_ID_LENGTH)) {
+            error = "invalid carrier code";
+        }
+    }
+
+    // Airports are added in table order, so they keep the same indices.
+    for (uint32_t i = 0; error == NULL && i < header.airport_count; i++) {
+        const char *code = (const char *)(data + layout.airports +
+                                          (size_t)i * SCHEDULE_FILE_CODE_SIZE);
+        airport_t *airport;
+
+        if (!valid_code(code, CODE_LENGTH)) {
+            error = "invalid airport code";
+        }
+        else if ((airport = find_airport(sim_param, code)) == NULL) {
+            error = "out of memory";
+        }
+        else if (airport->id != i) {
+            error = "duplicate airport code";
+        }
+    }
+
+    if (error == NULL) {
+        const uint16_t *number      = (const uint16_t *)(data + layout.number);
+        const uint16_t *carrier     = (const uint16_t *)(data + layout.carrier);
+        const uint32_t *plane       = (const uint32_t *)(data + layout.plane);
+        const uint32_t *origin      = (const uint32_t *)(data + layout.origin);
+        const uint32_t *destination = (const uint32_t *)(data +
+                                                         layout.destination);
+        const uint32_t *scheduled   = (const uint32_t *)(data +
+                                                         layout.scheduled);
+        const uint32_t *duration    = (const uint32_t *)(data +
+                                                         layout.duration);
+
+        for (uint32_t i = 0; error == NULL && i < header.flight_count; i++) {
+            flight_t entry = {
+                    .origin      = origin[i],
+                    .destination = destination[i],
+                    .plane       = plane[i],
+                    .time        = {.scheduled = scheduled[i],
+                                    .flight    = duration[i]}
+            };
+
+            if (carrier[i] >= header.carrier_count ||
+                origin[i] >= header.airport_count ||
+                destination[i] >= header.airport_count ||
+                plane[i] > PLANE_ID_MAX) {
+                error = "flight refers to a missing carrier, airport or plane";
+                continue;
+            }
+
+            const char *code = &carriers[(size_t)carrier[i] *
+                                         SCHEDULE_FILE_CODE_SIZE];
+
+            if (find_plane(sim_param, plane[i]) == NULL ||
+                insert_flight(sim_param, &entry, code, number[i]) == NULL) {
+                error = "out of memory";
+            }
+        }
+    }
+
+    unmap_file(data, file_size);
+
+    if (error != NULL) {
+        fprintf(stderr, "atsim: %s: %s\n", path, error);
+    }
+
+    return (error == NULL);
+}
@@ -0,0 +1,1495 @@
+/**
+ * @file    simulation.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that run a simulation,
+ *          from reading its schedule to outputting its results, along with
+ *          the airport workers that serve the runways.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkpoint.h"
+#include "schedule.h"
+#include "schedule_file.h"
+#include "metrics.h"
+#include "simulation.h"
+#include "sort.h"
+#include "stats.h"
+
+/* Notes on threading the program:
+ * Every airport and every plane belongs to a single worker, and a flight
+ * belongs to whichever of those its next update goes through: its plane's
+ * while it stands by or taxis in, as those look at or move the plane, its
+ * origin's while it taxis out to be queued there, and its destination's
+ * while it's en route to be queued there. Nothing a worker does on a tick
+ * touches what another worker owns, so each one goes through its own due
+ * flights in flight order, which queues them at its airports in the same
+ * order as updating every flight on a single thread did, and then serves
+ * its own runways.
+ * A flight moving on to another worker is handed over through its inbox,
+ * with a taxi or a flight ahead of it before its next event is due. The
+ * workers go through windows of as many ticks as the shortest of those on
+ * their own, in a single round of the barriers, and take in what they were
+ * handed at the start of the next one. A plane taking off from another
+ * worker's airport is handed over the same way, and is in the air from the
+ * tick after. Until its worker is told, the worker stops short of any tick
+ * where that could make a difference, and picks up from there in the next
+ * window.
+ */
+
+/**
+ * @brief   Runs a simulation, from reading its schedule to outputting the
+ *          last of its results.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Its stores have to be empty and its output ready. The schedule
+ *             is read into the stores and the results go to the output.
+ * @param   [in] input_fd: int
+ *          -- File descriptor the schedule is read from, unless a compiled
+ *             schedule is loaded instead. -1 if the stores already hold the
+ *             schedule, sorted.
+ * @details A simulation only ever touches its own parameters, so several of
+ *          them can run side by side. The stores are left for the caller to
+ *          reset or deinitialize, and the output is flushed but kept open.
+ *          Each phase is timed into the simulation's stats, if it has any.
+ * @return  bool
+ *          -- True if the simulation ran to the end, False if it failed.
+ */
+bool run_simulation(simulation_param_t *sim_param, int input_fd)
+{
+    stats_t *stats = sim_param->stats;
+    uint64_t start = (stats != NULL) ? stats_now() : 0, mark = start;
+    uint64_t ahead = 0;     // Ticks past the clock already gone through
+    bool success = true;
+
+    sim_param->clock        = UINT32_MAX;
+    sim_param->state        = READ_FLIGHT_INFO;
+    sim_param->complete     = false;
+    sim_param->thread_done  = false;
+    sim_param->runway_count = 0;
+    sim_param->last_clock   = NO_EVENT;
+
+    while (!sim_param->complete) {
+        switch (sim_param->state) {
+            /*
+             * READ_FLIGHT_INFO state
+             *
+             * In here, the system will process input from the console, or
+             * load the compiled schedule it was given.
+             * Next state is SIMULATE. It'll transition once the system captures
+             * the IN_END command from console, which tells the system that
+             * there are no more flight inputs and to start simulating.
+             */
+            case READ_FLIGHT_INFO: {
+                // The stores may already hold the schedule.
+                bool loaded = (input_fd < 0);
+
+                if (!loaded && !load_schedule(sim_param, input_fd)) {
+                    return false;
+                }
+
+                stats_phase(stats, STATS_PARSE, &mark);
+
+                // Compiling a schedule only writes it out, in input order.
+                if (sim_param->compile_path != NULL) {
+                    return write_schedule_file(sim_param,
+                                               sim_param->compile_path);
+                }
+
+                if (!loaded && !sort_flights(sim_param)) {
+                    fprintf(stderr, "atsim: out of memory\n");
+                    return false;
+                }
+
+                stats_phase(stats, STATS_SORT, &mark);
+
+                // The workers' events and runways in use are only gathered
+                // up for checkpoints. Every flight has at most one pending
+                // event at a time, and there can't be more runways in use
+                // than airports. Both are kept from one simulation to the
+                // next.
+                airport_t **runways = realloc(sim_param->runway_airports,
+                                              (sim_param->airports.count + 1) *
+                                              sizeof(airport_t *));
+
+                if (runways != NULL) {
+                    sim_param->runway_airports = runways;
+                }
+
+                if (!reset_event_queue(&sim_param->events,
+                                       sim_param->flight_count) ||
+                    runways == NULL) {
+                    fprintf(stderr, "atsim: out of memory\n");
+                    return false;
+                }
+
+                for (uint32_t i = 0; i < sim_param->airports.count; i++) {
+                    if (!init_airport(AIRPORT(sim_param, i))) {
+                        fprintf(stderr, "atsim: out of memory\n");
+                        return false;
+                    }
+                }
+
+                if (sim_param->runway_report &&
+                    !init_runway_metrics(sim_param)) {
+                    fprintf(stderr, "atsim: out of memory\n");
+                    return false;
+                }
+
+                if (!prepare_workers(sim_param)) {
+                    fprintf(stderr, "atsim: out of memory\n");
+                    return false;
+                }
+
+                if (sim_param->restore_path != NULL) {
+                    if (!load_checkpoint(sim_param, sim_param->restore_path)) {
+                        return false;
+                    }
+
+                    hand_out_events(sim_param);
+                }
+                else {
+                    // Every flight starts off waiting for its scheduled time.
+                    for (uint32_t i = 0; i < sim_param->flight_count; i++) {
+                        flight_t *flight = &sim_param->flights[i];
+
+                        push_event(&flight_worker(sim_param, flight)->events,
+                                   MAKE_EVENT(flight->time.scheduled, i));
+                    }
+
+                    for (int i = 0; i < sim_param->worker_count; i++) {
+                        worker_t *worker = &sim_param->workers[i];
+
+                        worker->next_clock = next_event_clock(&worker->events);
+                    }
+
+                    sim_param->clock = next_simulation_clock(sim_param);
+                }
+
+                start_workers(sim_param);
+                stats_phase(stats, STATS_SETUP, &mark);
+
+                sim_param->first_clock = sim_param->clock;
+
+                sim_param->state = (sim_param->clock > sim_param->horizon) ?
+                        SIMULATION_COMPLETE : SIMULATE;
+            } break;
+
+            /*
+             * SIMULATE state
+             *
+             * In here, the system will simulate the airport scheduling system.
+             * Each pass simulates a window of clock ticks, after which the
+             * clock is moved to the next tick that has an event due or a
+             * runway with flights waiting on it.
+             * Next state is SIMULATION_COMPLETE. It'll transition once there
+             * are no events left within the simulation's time frame.
+             */
+            case SIMULATE: {
+                // The checkpoint is taken before the first tick at or past
+                // its clock, so a restored simulation resumes from that tick.
+                if (sim_param->clock >= sim_param->checkpoint_at) {
+                    sim_param->checkpoint_at = NO_EVENT;
+                    gather_workers(sim_param);
+
+                    if (!write_checkpoint(sim_param,
+                                          sim_param->checkpoint_path)) {
+                        success = false;
+                        sim_param->state = SIMULATION_COMPLETE;
+                        break;
+                    }
+                }
+
+                // A window never goes past the checkpoint, nor past the
+                // last tick simulated.
+                uint32_t end = sim_param->clock + sim_param->lookahead;
+
+                if (sim_param->checkpoint_at < end) {
+                    end = sim_param->checkpoint_at;
+                }
+
+                if (end > sim_param->horizon + 1) {
+                    end = sim_param->horizon + 1;
+                }
+
+                sim_param->window_end = end;
+
+                uint32_t clock = sim_param->clock;
+                uint64_t worked = 0;
+
+                // Every worker updates its own flights with an event due in
+                // the window and serves its own runways.
+                bool ran = run_window(sim_param);
+                stats_phase(stats, STATS_TICKS, &mark);
+
+                if (!ran) {
+                    fprintf(stderr, "atsim: out of memory\n");
+                    success = false;
+                    sim_param->state = SIMULATION_COMPLETE;
+                    break;
+                }
+
+                for (int i = 0; i < sim_param->worker_count; i++) {
+                    worked |= sim_param->workers[i].worked;
+                }
+
+                if (!collect_completed_flights(sim_param)) {
+                    fprintf(stderr, "atsim: out of memory\n");
+                    success = false;
+                    sim_param->state = SIMULATION_COMPLETE;
+                    break;
+                }
+
+                // The clock jumps straight to the next tick where something
+                // can happen, and the simulation ends once nothing can.
+                sim_param->clock = next_simulation_clock(sim_param);
+
+                /*
+                 * A worker that stopped short of the window's end goes back
+                 * to ticks other workers already went through, which are
+                 * only counted once, and which may not be the last ones.
+                 * There's always work on the first tick of a window.
+                 */
+                uint32_t last = clock + (WINDOW_MAX_TICKS - 1) -
+                                __builtin_clzll(worked | 1);
+                uint32_t shift = sim_param->clock - clock;
+                uint32_t completed = sim_param->completed_count;
+
+                if (sim_param->last_clock == NO_EVENT ||
+                    last > sim_param->last_clock) {
+                    sim_param->last_clock = last;
+                }
+
+                if (stats != NULL) {
+                    stats->ticks += __builtin_popcountll(worked & ~ahead);
+                }
+
+                ahead = (shift < WINDOW_MAX_TICKS) ?
+                        (worked | ahead) >> shift : 0;
+
+                // Flights only complete here, so the results of the ticks
+                // every worker is through are final and can be output
+                // already.
+                if (sim_param->completed_count > 0 &&
+                    !produce_simulation_results(sim_param)) {
+                    success = false;
+                    sim_param->state = SIMULATION_COMPLETE;
+                    break;
+                }
+
+                if (stats != NULL) {
+                    stats->results += completed - sim_param->completed_count;
+                }
+
+                stats_phase(stats, STATS_RESULTS, &mark);
+
+                if (sim_param->clock > sim_param->horizon) {
+                    sim_param->state = SIMULATION_COMPLETE;
+                }
+            } break;
+
+            /*
+             * SIMULATION_COMPLETE state
+             *
+             * It stops the airport workers and sets the simulation complete
+             * flag, which will end the simulation in the following program
+             * loop pass.
+             */
+            case SIMULATION_COMPLETE: {
+                if (sim_param->checkpoint_at != NO_EVENT) {
+                    fprintf(stderr, "atsim: the simulation ended before the "
+                                    "checkpoint was due, none was taken\n");
+                }
+
+                stop_workers(sim_param);
+
+                for (uint32_t i = 0; i < sim_param->airports.count; i++) {
+                    deinit_airport(AIRPORT(sim_param, i));
+                }
+
+                success = output_flush(&sim_param->output) && success;
+                sim_param->complete = true;
+
+                if (stats != NULL) {
+                    stats_phase(stats, STATS_FINISH, &mark);
+                    stats->total_ns = mark - start;
+                    stats->events_left = 0;
+                    stats->flights = sim_param->flight_count;
+                    stats->workers = sim_param->worker_count;
+
+                    for (int i = 0; i < sim_param->worker_count; i++) {
+                        worker_t *worker = &sim_param->workers[i];
+                        worker_stats_t *counted = &stats->worker[i];
+
+                        stats->events_left += worker->events.count +
+                                              mailbox_size(&worker->inbox);
+                        stats->events_popped += counted->events_popped;
+
+                        for (int j = 0; j < STATS_FLIGHT_STATES; j++) {
+                            stats->transitions[j] += counted->transitions[j];
+                        }
+                    }
+
+                    // A lone worker is the main thread running the ticks.
+                    if (sim_param->worker_count == 1) {
+                        stats->worker[0].busy_ns =
+                                stats->phase_ns[STATS_TICKS];
+                    }
+                }
+            }break;
+        }
+    }
+
+    return success;
+}
+
+/**
+ * @brief   Reads a simulation's schedule into its stores.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the stores of the simulation, which have to be empty.
+ * @param   [in] input_fd: int
+ *          -- File descriptor the schedule is read from, unless a compiled
+ *             schedule is loaded instead.
+ * @return  bool
+ *          -- True if the schedule was read, False if not.
+ */
+bool load_schedule(simulation_param_t *sim_param, int input_fd)
+{
+    if (sim_param->schedule_path != NULL) {
+        return load_schedule_file(sim_param, sim_param->schedule_path);
+    }
+
+    if (!read_schedule(sim_param, input_fd)) {
+        perror("atsim: reading the schedule");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Hands the airports and planes out to the workers, and readies
+ *          each worker for the flights it owns.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the owners of the airports and planes, and the workers.
+ * @details There's never more workers than airports, as a worker without an
+ *          airport would have hardly anything to do.
+ *          The busiest airports are handed out first, each to the worker with
+ *          the fewest flights going through its airports so far, so the
+ *          workers end up with near equal shares of the flights. A plane goes
+ *          to the worker of the airport its first flight departs from.
+ *          A worker's events are sized to the flights it may ever own, and
+ *          its inboxes to what may ever be handed over to it, as a flight is
+ *          only ever handed over to the same worker once.
+ *          A flight is handed over with a taxi or a flight ahead of it, so a
+ *          window may span as many ticks as the shortest of those that ever
+ *          hands a flight over. Windows are a single tick when streaming, so
+ *          each tick's results are still written out as soon as it's over.
+ * @return  bool
+ *          -- True if the workers are ready, False if memory ran out.
+ */
+bool prepare_workers(simulation_param_t *sim_param)
+{
+    uint32_t airports = sim_param->airports.count;
+
+    if (sim_param->worker_count > airports) {
+        sim_param->worker_count = (airports > 0) ? airports : 1;
+    }
+
+    uint16_t workers = sim_param->worker_count;
+    uint64_t *keys = malloc((size_t)airports * sizeof(uint64_t) + 1);
+    uint32_t *order = malloc((size_t)airports * sizeof(uint32_t) + 1);
+    uint16_t *plane_workers = realloc(sim_param->plane_workers,
+                                      (size_t)sim_param->planes.count *
+                                      sizeof(uint16_t) + 1);
+    uint32_t *plane_takeoffs = realloc(sim_param->plane_takeoffs,
+                                       (size_t)sim_param->planes.count *
+                                       sizeof(uint32_t) + 1);
+    uint32_t lookahead = WINDOW_MAX_TICKS;
+    uint64_t loads[WORKER_MAX_COUNT] = {0};
+    uint32_t owned[WORKER_MAX_COUNT] = {0};
+    uint32_t flights[WORKER_MAX_COUNT] = {0};
+    uint32_t inbound[WORKER_MAX_COUNT] = {0};
+    uint32_t takeoffs[WORKER_MAX_COUNT] = {0};
+    bool ready = (keys != NULL && order != NULL);
+
+    // Sorting on the load's complement puts the busiest airports first.
+    for (uint32_t i = 0; ready && i < airports; i++) {
+        airport_t *airport = AIRPORT(sim_param, i);
+        uint64_t load = (uint64_t)airport->departure_count +
+                        airport->arrival_count;
+
+        keys[i] = ((UINT32_MAX - ((load < UINT32_MAX) ? load : UINT32_MAX))
+                   << 32) | i;
+    }
+
+    ready = ready && (airports == 0 || sort_permutation(keys, order, airports));
+
+    for (uint32_t i = 0; ready && i < airports; i++) {
+        airport_t *airport = AIRPORT(sim_param, order[i]);
+        uint16_t least = 0;
+
+        for (uint16_t j = 1; j < workers; j++) {
+            if (loads[j] < loads[least]) {
+                least = j;
+            }
+        }
+
+        airport->worker = least;
+        loads[least] += (uint64_t)airport->departure_count +
+                        airport->arrival_count;
+        owned[least]++;
+    }
+
+    if (plane_workers != NULL) {
+        sim_param->plane_workers = plane_workers;
+    }
+
+    if (plane_takeoffs != NULL) {
+        sim_param->plane_takeoffs = plane_takeoffs;
+    }
+
+    ready = ready && plane_workers != NULL && plane_takeoffs != NULL;
+
+    for (uint32_t i = 0; ready && i < sim_param->planes.count; i++) {
+        plane_workers[i] = (workers > 1) ? WORKER_NONE : 0;
+        plane_takeoffs[i] = 0;
+    }
+
+    // A lone worker owns every flight, and is never handed any.
+    flights[0] = (workers > 1) ? 0 : sim_param->flight_count;
+
+    for (uint32_t i = 0; ready && workers > 1 && i < sim_param->flight_count;
+         i++) {
+        flight_t *flight = &sim_param->flights[i];
+        uint16_t plane = plane_workers[flight->plane];
+        uint16_t origin = AIRPORT(sim_param, flight->origin)->worker;
+        uint16_t destination = AIRPORT(sim_param, flight->destination)->worker;
+
+        if (plane == WORKER_NONE) {
+            plane = plane_workers[flight->plane] = origin;
+        }
+
+        // The flight is handed from its plane's worker to its origin's, then
+        // to its destination's, and back to its plane's.
+        inbound[origin] += (origin != plane);
+        inbound[destination] += (destination != origin);
+        inbound[plane] += (plane != destination);
+        takeoffs[plane] += (plane != origin);
+
+        flights[plane]++;
+        flights[origin] += (origin != plane);
+        flights[destination] += (destination != origin &&
+                                 destination != plane);
+
+        // Durations of 0 never raise an event, so nothing is handed over.
+        if (origin != plane && flight->taxi_out > 0 &&
+            flight->taxi_out < lookahead) {
+            lookahead = flight->taxi_out;
+        }
+
+        if (destination != origin && flight->time.flight > 0 &&
+            flight->time.flight < lookahead) {
+            lookahead = flight->time.flight;
+        }
+
+        if (plane != destination && flight->taxi_in > 0 &&
+            flight->taxi_in < lookahead) {
+            lookahead = flight->taxi_in;
+        }
+    }
+
+    sim_param->lookahead = sim_param->stream ? 1 : lookahead;
+
+    for (uint16_t i = 0; ready && i < workers; i++) {
+        worker_t *worker = &sim_param->workers[i];
+        airport_t **runways = realloc(worker->runways,
+                                      ((size_t)owned[i] + 1) *
+                                      sizeof(airport_t *));
+        uint32_t *due = realloc(worker->due, ((size_t)flights[i] + 1) *
+                                             sizeof(uint32_t));
+
+        if (runways != NULL) {
+            worker->runways = runways;
+        }
+
+        if (due != NULL) {
+            worker->due = due;
+        }
+
+        deinit_mailbox(&worker->inbox);
+        deinit_mailbox(&worker->takeoffs);
+        ready = (runways != NULL && due != NULL &&
+                 reset_event_queue(&worker->events, flights[i]) &&
+                 reset_event_queue(&worker->departed, takeoffs[i]) &&
+                 init_mailbox(&worker->inbox, inbound[i]) == 0 &&
+                 init_mailbox(&worker->takeoffs, takeoffs[i]) == 0);
+
+        worker->runway_count    = 0;
+        worker->completed_count = 0;
+        worker->failed          = false;
+        worker->abroad          = 0;
+        worker->worked          = 0;
+        worker->sent_clock      = NO_EVENT;
+        worker->next_clock      = NO_EVENT;
+        worker->sim_param       = sim_param;
+        worker->stats           = (sim_param->stats != NULL) ?
+                &sim_param->stats->worker[i] : NULL;
+    }
+
+    free(keys);
+    free(order);
+    return ready;
+}
+
+/**
+ * @brief   Finds the worker that owns a flight.
+ * @param   [in] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ * @param   [in] flight: flight_t*
+ *          -- Pointer to the flight.
+ * @details The states that look at or move the plane belong to the plane's
+ *          worker, and the others to the worker of the airport the flight
+ *          queues at next, or last queued at.
+ * @return  worker_t*
+ *          -- Pointer to the worker that owns the flight.
+ */
+worker_t* flight_worker(simulation_param_t *sim_param, flight_t *flight)
+{
+    uint16_t worker;
+
+    switch (flight->state) {
+        case DEPARTURE_TAXI:
+        case WAIT_TO_TAKEOFF: {
+            worker = AIRPORT(sim_param, flight->origin)->worker;
+        } break;
+
+        case EN_ROUTE:
+        case WAIT_TO_LAND: {
+            worker = AIRPORT(sim_param, flight->destination)->worker;
+        } break;
+
+        default: {
+            worker = sim_param->plane_workers[flight->plane];
+        } break;
+    }
+
+    return &sim_param->workers[worker];
+}
+
+/**
+ * @brief   Hands the events and runways in use restored from a checkpoint
+ *          out to the workers that own them.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Empties the simulation's own event queue and list of runways
+ *             in use into the workers'.
+ * @details A flight taxiing out or waiting at another worker's airport is
+ *          yet to take off with its plane, which its plane's worker has to
+ *          be told of. A plane that already took off was in the air when
+ *          the checkpoint was saved.
+ */
+void hand_out_events(simulation_param_t *sim_param)
+{
+    for (uint32_t i = 0; i < sim_param->events.count; i++) {
+        sim_event_t event = sim_param->events.heap[i];
+        flight_t *flight = &sim_param->flights[EVENT_FLIGHT(event)];
+
+        push_event(&flight_worker(sim_param, flight)->events, event);
+    }
+
+    for (uint32_t i = 0; i < sim_param->runway_count; i++) {
+        airport_t *airport = sim_param->runway_airports[i];
+        worker_t *worker = &sim_param->workers[airport->worker];
+
+        worker->runways[worker->runway_count++] = airport;
+    }
+
+    for (uint32_t i = 0; i < sim_param->flight_count; i++) {
+        flight_t *flight = &sim_param->flights[i];
+        worker_t *worker =
+                &sim_param->workers[sim_param->plane_workers[flight->plane]];
+
+        // A taxi out of no time never ends, as it raises no event.
+        if (((flight->state == DEPARTURE_TAXI && flight->taxi_out > 0) ||
+             flight->state == WAIT_TO_TAKEOFF) &&
+            flight_worker(sim_param, flight) != worker) {
+            sim_param->plane_takeoffs[flight->plane]++;
+            worker->abroad++;
+        }
+    }
+
+    for (int i = 0; i < sim_param->worker_count; i++) {
+        worker_t *worker = &sim_param->workers[i];
+
+        worker->next_clock = (worker->runway_count > 0) ?
+                sim_param->clock : next_event_clock(&worker->events);
+    }
+
+    sim_param->events.count = 0;
+    sim_param->runway_count = 0;
+}
+
+/**
+ * @brief   Gathers every worker's events and runways in use into the
+ *          simulation's own, so they can be saved.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the simulation's own event queue and list of runways
+ *             in use, and empties every worker's inboxes.
+ * @details The workers keep everything they had, so the simulation goes on
+ *          just as if nothing had been gathered.
+ *          Every worker has gone through every tick before the current one,
+ *          so every plane that took off is in the air by now.
+ */
+void gather_workers(simulation_param_t *sim_param)
+{
+    sim_param->events.count = 0;
+    sim_param->runway_count = 0;
+
+    for (int i = 0; i < sim_param->worker_count; i++) {
+        worker_t *worker = &sim_param->workers[i];
+
+        worker->clock = sim_param->clock;
+        receive_flights(worker);
+        take_off_planes(worker);
+
+        for (uint32_t j = 0; j < worker->events.count; j++) {
+            push_event(&sim_param->events, worker->events.heap[j]);
+        }
+
+        for (uint32_t j = 0; j < worker->runway_count; j++) {
+            sim_param->runway_airports[sim_param->runway_count++] =
+                    worker->runways[j];
+        }
+    }
+}
+
+/**
+ * @brief   Has every worker go through its ticks of the current window.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Uses and alters the workers, and everything they own.
+ * @details The main thread waits for all of them to be done. A single
+ *          worker's window is run by the main thread itself.
+ * @return  bool
+ *          -- True if every worker went through the window, False if one of
+ *             them ran out of memory.
+ */
+bool run_window(simulation_param_t *sim_param)
+{
+    bool ran = true;
+
+    if (sim_param->worker_count == 1) {
+        return run_worker_window(&sim_param->workers[0]);
+    }
+
+    // Here the workers begin to go through the window concurrently.
+    sim_barrier_wait(&sim_param->airport_start_sync);
+
+    /*
+     * Here all workers are synced when they're done.
+     * It also makes sure the main thread only looks at the flights they
+     * completed and the clocks they're due at after they've been written to.
+     */
+    sim_barrier_wait(&sim_param->airport_end_sync);
+
+    // Any worker that ran out of memory fails the whole window.
+    for (int i = 0; i < sim_param->worker_count; i++) {
+        ran = ran && !sim_param->workers[i].failed;
+    }
+
+    return ran;
+}
+
+/**
+ * @brief   Has a worker go through its ticks of the current window.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker.
+ *          -- Uses and alters everything it owns.
+ * @details The worker takes in what it was handed first. Nothing is handed
+ *          over to it that is due before the window ends, so it goes through
+ *          every tick of the window it has work on without waiting on the
+ *          other workers, until it comes to a tick it can't be sure of yet.
+ *          The next tick it has work on is where it stopped. The earliest of
+ *          the events it handed over is kept apart, as those are the other
+ *          workers' work.
+ *          A worker that runs out of memory stops where it is.
+ * @return  bool
+ *          -- True if the worker went through the window, False if it ran
+ *             out of memory.
+ */
+bool run_worker_window(worker_t *worker)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+    uint32_t start = sim_param->clock, end = sim_param->window_end;
+
+    worker->sent_clock = NO_EVENT;
+    worker->worked = 0;
+    receive_flights(worker);
+
+    uint32_t next = next_event_clock(&worker->events);
+
+    worker->clock = (worker->next_clock < next) ? worker->next_clock : next;
+
+    while (!worker->failed && worker->clock < end &&
+           run_worker_tick(worker, worker->clock > start)) {
+        worker->worked |= (uint64_t)1 << (worker->clock - start);
+        worker->clock = (worker->runway_count > 0) ?
+                worker->clock + 1 : next_event_clock(&worker->events);
+    }
+
+    worker->next_clock = worker->clock;
+    return !worker->failed;
+}
+
+/**
+ * @brief   Has a worker go through a clock tick.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker, on the tick it goes through.
+ *          -- Uses and alters everything it owns.
+ * @param   [in] check: bool
+ *          -- Whether the planes of the flights due have to be checked,
+ *             which they do past the start of the window.
+ * @details The planes that took off before the tick are in the air first.
+ *          Then the worker takes its flights with an event due out of its
+ *          events all at once, in flight order. They're updated in that
+ *          order, each after the flights released by their planes for this
+ *          same tick that come before it. Its runways are served once every
+ *          due flight is through.
+ *          Past the start of the window, another worker may have had one of
+ *          the worker's planes take off on an earlier tick of the window
+ *          without the worker knowing yet. The tick is left for the next
+ *          window if any of the flights due looks at such a plane.
+ * @return  bool
+ *          -- True if the worker went through the tick, False if it's left
+ *             for the next window.
+ */
+bool run_worker_tick(worker_t *worker, bool check)
+{
+    uint32_t clock = worker->clock;
+    uint32_t count = 0;
+
+    take_off_planes(worker);
+
+    while (next_event_clock(&worker->events) <= clock) {
+        worker->due[count++] = EVENT_FLIGHT(pop_event(&worker->events));
+    }
+
+    if (check && worker->abroad > 0 && !planes_settled(worker, count)) {
+        for (uint32_t i = 0; i < count; i++) {
+            push_event(&worker->events, MAKE_EVENT(clock, worker->due[i]));
+        }
+
+        return false;
+    }
+
+    if (worker->stats != NULL) {
+        worker->stats->events_popped += count;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        update_released_flights(worker, MAKE_EVENT(clock, worker->due[i]));
+        update_due_flight(worker, worker->due[i]);
+    }
+
+    update_released_flights(worker, MAKE_EVENT(clock + 1, 0));
+    serve_runways(worker);
+    return true;
+}
+
+/**
+ * @brief   Checks that no flight due on a worker's tick looks at a plane
+ *          that may have taken off without the worker being told.
+ * @param   [in] worker: worker_t*
+ *          -- Pointer to the worker, with its due flights taken out of its
+ *             events.
+ * @param   [in] count: uint32_t
+ *          -- Number of flights due.
+ * @details Only flights standing by or taxiing in look at their plane.
+ *          Those belong to the plane's worker, the only one that counts its
+ *          takeoffs, so the count is only read for them.
+ *          A flight standing by only tells a plane in the air apart from one
+ *          elsewhere if the plane is still at the flight's origin.
+ * @return  bool
+ *          -- True if the flights can be updated, False if not.
+ */
+bool planes_settled(worker_t *worker, uint32_t count)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+
+    for (uint32_t i = 0; i < count; i++) {
+        flight_t *flight = &sim_param->flights[worker->due[i]];
+
+        if ((flight->state == ARRIVAL_TAXI ||
+             (flight->state == STAND_BY &&
+              PLANE(sim_param, flight->plane)->airport == flight->origin)) &&
+            sim_param->plane_takeoffs[flight->plane] > 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Updates a flight that has an event due on the worker's clock tick
+ *          and schedules its next one.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker that owns the flight.
+ *          -- Uses and alters whatever the flight's update goes through.
+ * @param   [in] index: uint32_t
+ *          -- Index of the flight that is due.
+ */
+void update_due_flight(worker_t *worker, uint32_t index)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+    flight_t *flight = &sim_param->flights[index];
+    flight_states_t state = flight->state;
+
+    update_flight(flight, &sim_param->planes, worker->clock);
+
+    if (worker->stats != NULL) {
+        worker->stats->transitions[flight->state] += (flight->state != state);
+    }
+
+    schedule_flight(worker, index);
+}
+
+/**
+ * @brief   Updates the flights that were released by their planes for the
+ *          worker's clock tick, up to a given event.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker that owns the planes.
+ *          -- Uses and alters its events.
+ * @param   [in] until: sim_event_t
+ *          -- Event the flights taken out of the events are ordered before.
+ * @details Only flights released on this tick can be due on it once the due
+ *          flights have been taken out of the events.
+ */
+void update_released_flights(worker_t *worker, sim_event_t until)
+{
+    while (next_event(&worker->events) < until) {
+        uint32_t index = EVENT_FLIGHT(pop_event(&worker->events));
+
+        if (worker->stats != NULL) {
+            worker->stats->events_popped++;
+        }
+
+        update_due_flight(worker, index);
+    }
+}
+
+/**
+ * @brief   Takes in what was handed over to a worker.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker.
+ *          -- Empties its inboxes into its events and departed planes.
+ * @details Flights are only handed over with an event of their own, which is
+ *          due after the window they were handed over in.
+ *          A plane that took off is only in the air from the tick after, as
+ *          the runways are served after every flight has been updated, and
+ *          the worker may not be past that tick yet.
+ */
+void receive_flights(worker_t *worker)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+    uint32_t index;
+
+    while ((index = mailbox_try_pop(&worker->inbox)) != FLIGHT_NONE) {
+        push_event(&worker->events, MAKE_EVENT(
+                next_flight_event(&sim_param->flights[index]), index));
+    }
+
+    // Departed planes are keyed like events, on the plane instead.
+    while ((index = mailbox_try_pop(&worker->takeoffs)) != FLIGHT_NONE) {
+        flight_t *flight = &sim_param->flights[index];
+
+        push_event(&worker->departed,
+                   MAKE_EVENT(flight->time.departure + 1, flight->plane));
+    }
+}
+
+/**
+ * @brief   Puts the planes of a worker that took off from another worker's
+ *          airport in the air, once the worker's clock reaches the tick
+ *          after their takeoff.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker, on the tick it goes through.
+ *          -- Alters its departed planes, and the planes themselves.
+ */
+void take_off_planes(worker_t *worker)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+
+    while (next_event_clock(&worker->departed) <= worker->clock) {
+        uint32_t plane = EVENT_FLIGHT(pop_event(&worker->departed));
+
+        PLANE(sim_param, plane)->airport = PLANE_ON_AIR;
+        sim_param->plane_takeoffs[plane]--;
+        worker->abroad--;
+    }
+}
+
+/**
+ * @brief   Schedules the next event of a flight.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker that owns the flight.
+ *          -- Uses and alters its events, its airports' queues, its list
+ *             of runways in use and its planes' waiting lists.
+ * @param   [in] index: uint32_t
+ *          -- Index of the flight that just went through an update.
+ * @details A flight that is past its scheduled time but still standing by
+ *          is waiting on its plane. If the plane is grooming at the flight's
+ *          origin the flight is checked again once the grooming is done,
+ *          otherwise it waits on the plane until the plane lands somewhere.
+ *          Flights that just moved into a waiting state are queued at their
+ *          airport, which makes sure the airport serves its runway.
+ *          Events that have already gone by are never caught by the flight's
+ *          update, so they are not scheduled.
+ *          A worker that can't hold on to a flight that completed is marked
+ *          as failed.
+ */
+void schedule_flight(worker_t *worker, uint32_t index)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+    flight_t *flight = &sim_param->flights[index];
+    uint32_t clock = next_flight_event(flight);
+
+    switch (flight->state) {
+        case STAND_BY: {
+            if (clock <= worker->clock) {
+                plane_t *plane = PLANE(sim_param, flight->plane);
+
+                if (plane->airport == flight->origin) {
+                    clock = plane->ready_at;
+                }
+                else {
+                    sim_param->flight_info[index].next_waiting =
+                            plane->waiting;
+                    plane->waiting = index;
+                    clock = NO_EVENT;
+                }
+            }
+        } break;
+
+        case WAIT_TO_TAKEOFF: {
+            airport_t *airport = AIRPORT(sim_param, flight->origin);
+
+            queue_departure(airport, index);
+            activate_runway(worker, airport);
+        } break;
+
+        case WAIT_TO_LAND: {
+            airport_t *airport = AIRPORT(sim_param, flight->destination);
+
+            queue_arrival(airport, index);
+            activate_runway(worker, airport);
+        } break;
+
+        case COMPLETE: {
+            release_waiting_flights(worker, PLANE(sim_param, flight->plane));
+
+            if (!log_completed_flight(worker, index)) {
+                worker->failed = true;
+            }
+        } break;
+
+        default:
+            break;
+    }
+
+    if (clock != NO_EVENT && clock > worker->clock) {
+        post_event(worker, index, clock);
+    }
+}
+
+/**
+ * @brief   Schedules an event for a flight with the worker that owns it.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker that last updated the flight.
+ *          -- Alters its events, or the earliest event it handed over.
+ * @param   [in] index: uint32_t
+ *          -- Index of the flight.
+ * @param   [in] clock: uint32_t
+ *          -- Clock tick the event is due at.
+ * @details A flight that moved into a state some other worker owns is handed
+ *          over to it, and that worker schedules the event itself.
+ *          A flight taxiing out to another worker's airport is going to
+ *          take off with its plane there, which the worker is told of later.
+ */
+void post_event(worker_t *worker, uint32_t index, uint32_t clock)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+    flight_t *flight = &sim_param->flights[index];
+    worker_t *owner = (sim_param->worker_count > 1) ?
+            flight_worker(sim_param, flight) : worker;
+
+    if (owner == worker) {
+        push_event(&worker->events, MAKE_EVENT(clock, index));
+        return;
+    }
+
+    if (flight->state == DEPARTURE_TAXI) {
+        sim_param->plane_takeoffs[flight->plane]++;
+        worker->abroad++;
+    }
+
+    // The inbox is sized to every flight that could ever be handed over.
+    mailbox_enqueue(&owner->inbox, index);
+
+    if (clock < worker->sent_clock) {
+        worker->sent_clock = clock;
+    }
+}
+
+/**
+ * @brief   Holds on to a flight that just completed until its results are
+ *          output.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker that owns the flight.
+ *          -- Alters its list of flights completed in this window.
+ * @param   [in] index: uint32_t
+ *          -- Index of the flight that just completed.
+ * @details Simulations that record their completions only note down the
+ *          clock the flight completed at, and output nothing.
+ * @return  bool
+ *          -- True if the flight is held on to, False if memory ran out.
+ */
+bool log_completed_flight(worker_t *worker, uint32_t index)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+
+    if (sim_param->completions != NULL) {
+        sim_param->completions[index] = sim_param->flights[index].time.arrival;
+        return true;
+    }
+
+    if (worker->completed_count == worker->completed_capacity) {
+        uint32_t capacity = (worker->completed_capacity > 0) ?
+                worker->completed_capacity * 2 : COMPLETED_CAPACITY_HINT;
+        uint32_t *completed = realloc(worker->completed,
+                                      (size_t)capacity * sizeof(uint32_t));
+
+        if (completed == NULL) {
+            return false;
+        }
+
+        worker->completed = completed;
+        worker->completed_capacity = capacity;
+    }
+
+    worker->completed[worker->completed_count++] = index;
+    return true;
+}
+
+/**
+ * @brief   Releases the flights waiting on a plane that just landed.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker that owns the plane.
+ *          -- Uses and alters its events.
+ * @param   [in, out] plane: plane_t*
+ *          -- Pointer to the plane that just landed.
+ * @details Only the flights departing from where the plane landed can use it,
+ *          and they are checked again once it is done grooming.
+ *          Every other flight keeps waiting on the plane.
+ */
+void release_waiting_flights(worker_t *worker, plane_t *plane)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+    uint32_t *link = &plane->waiting;
+
+    while (*link != FLIGHT_NONE) {
+        uint32_t index = *link;
+        flight_info_t *info = &sim_param->flight_info[index];
+
+        if (sim_param->flights[index].origin == plane->airport) {
+            *link = info->next_waiting;
+            push_event(&worker->events, MAKE_EVENT(plane->ready_at, index));
+        }
+        else {
+            link = &info->next_waiting;
+        }
+    }
+}
+
+/**
+ * @brief   Adds an airport to its worker's list of runways in use.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker that owns the airport.
+ *          -- Uses and alters its list of runways in use.
+ * @param   [in, out] airport: airport_t*
+ *          -- Pointer to an airport that just had a flight queued.
+ */
+void activate_runway(worker_t *worker, airport_t *airport)
+{
+    if (!airport->runway_active) {
+        airport->runway_active = true;
+        worker->runways[worker->runway_count++] = airport;
+    }
+}
+
+/**
+ * @brief   Has a worker serve its runways in use for this tick.
+ * @param   [in, out] worker: worker_t*
+ *          -- Pointer to the worker.
+ *          -- Uses and alters its list of runways in use, the airports on
+ *             it and its events.
+ * @details The flight that used each runway has its next event scheduled
+ *          right away, as it can't be due before the next tick, and airports
+ *          left with no flights queued are taken off the list.
+ *          A flight that took off leaves its plane in the air, which another
+ *          worker owning the plane is told of with the flight.
+ */
+void serve_runways(worker_t *worker)
+{
+    simulation_param_t *sim_param = worker->sim_param;
+    worker_stats_t *stats = worker->stats;
+    uint32_t runways = worker->runway_count, count = 0;
+
+    for (uint32_t i = 0; i < runways; i++) {
+        airport_t *airport = worker->runways[i];
+
+        manage_runway(airport, sim_param->flights, worker->clock);
+
+        uint32_t index = airport->runway_flight;
+
+        if (index != FLIGHT_NONE) {
+            flight_t *flight = &sim_param->flights[index];
+
+            if (flight->state == EN_ROUTE) {
+                worker_t *owner = &sim_param->workers[
+                        sim_param->plane_workers[flight->plane]];
+
+                if (owner == worker) {
+                    PLANE(sim_param, flight->plane)->airport = PLANE_ON_AIR;
+                }
+                else {
+                    mailbox_enqueue(&owner->takeoffs, index);
+                }
+            }
+
+            if (stats != NULL) {
+                stats->transitions[flight->state]++;
+            }
+
+            schedule_flight(worker, index);
+            airport->runway_flight = FLIGHT_NONE;
+        }
+
+        if (size(&airport->departures_queue) != EMPTY_QUEUE ||
+            size(&airport->arrivals_queue) != EMPTY_QUEUE) {
+            worker->runways[count++] = airport;
+        }
+        else {
+            airport->runway_active = false;
+        }
+    }
+
+    if (stats != NULL) {
+        stats->airports += runways;
+    }
+
+    worker->runway_count = count;
+}
+
+/**
+ * @brief   Gathers the flights every worker completed in this window.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Alters the list of flights completed in this window, and
+ *             empties the workers' own.
+ * @details Each worker completes the flights of a tick in flight order, and
+ *          when more than one of them completed any, or some were held back
+ *          from an earlier window, the list is sorted back into flight order,
+ *          so the flights of each tick are in the order they'd have completed
+ *          in on a single worker.
+ * @return  bool
+ *          -- True if the flights were gathered, False if memory ran out.
+ */
+bool collect_completed_flights(simulation_param_t *sim_param)
+{
+    uint16_t sources = (sim_param->completed_count > 0);
+
+    for (int i = 0; i < sim_param->worker_count; i++) {
+        worker_t *worker = &sim_param->workers[i];
+        uint32_t count = sim_param->completed_count + worker->completed_count;
+
+        if (worker->completed_count == 0) {
+            continue;
+        }
+
+        if (count > sim_param->completed_capacity) {
+            uint32_t capacity = (sim_param->completed_capacity > 0) ?
+                    sim_param->completed_capacity : COMPLETED_CAPACITY_HINT;
+
+            while (capacity < count) {
+                capacity *= 2;
+            }
+
+            uint32_t *completed = realloc(sim_param->completed,
+                                          (size_t)capacity * sizeof(uint32_t));
+
+            if (completed == NULL) {
+                return false;
+            }
+
+            sim_param->completed = completed;
+            sim_param->completed_capacity = capacity;
+        }
+
+        memcpy(sim_param->completed + sim_param->completed_count,
+               worker->completed, worker->completed_count * sizeof(uint32_t));
+        sim_param->completed_count = count;
+        worker->completed_count = 0;
+        sources++;
+    }
+
+    if (sources < 2) {
+        return true;
+    }
+
+    uint32_t count = sim_param->completed_count;
+    uint64_t *keys = malloc((size_t)count * sizeof(uint64_t));
+    uint32_t *order = malloc((size_t)count * sizeof(uint32_t));
+    bool sorted = (keys != NULL && order != NULL);
+
+    for (uint32_t i = 0; sorted && i < count; i++) {
+        keys[i] = sim_param->completed[i];
+    }
+
+    sorted = sorted && sort_permutation(keys, order, count);
+
+    // The keys are the flights themselves, so they're put back in order.
+    for (uint32_t i = 0; sorted && i < count; i++) {
+        sim_param->completed[i] = (uint32_t)keys[order[i]];
+    }
+
+    free(keys);
+    free(order);
+    return sorted;
+}
+
+/**
+ * @brief   Finds the next clock tick the simulation has to go through.
+ * @param   [in] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ * @details Each worker knows the next tick it has work on, and the earliest
+ *          event it handed over, so the simulation has nothing to do before
+ *          the earliest of them.
+ * @return  uint32_t
+ *          -- Next clock tick to simulate, or NO_EVENT if there is none.
+ */
+uint32_t next_simulation_clock(simulation_param_t *sim_param)
+{
+    uint32_t clock = NO_EVENT;
+
+    for (int i = 0; i < sim_param->worker_count; i++) {
+        worker_t *worker = &sim_param->workers[i];
+
+        if (worker->next_clock < clock) {
+            clock = worker->next_clock;
+        }
+
+        if (worker->sent_clock < clock) {
+            clock = worker->sent_clock;
+        }
+    }
+
+    return clock;
+}
+
+/**
+ * @brief   Starts the pool of airport workers.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Uses and alters the workers and the barriers.
+ * @details No thread is started for a single worker.
+ */
+void start_workers(simulation_param_t *sim_param)
+{
+    uint16_t workers = sim_param->worker_count;
+
+    // A single worker would only ever run while the main thread waits on it,
+    // so the main thread runs the ticks itself instead.
+    if (workers == 1) {
+        return;
+    }
+
+    sim_barrier_init(&sim_param->airport_start_sync, (workers+1));
+    sim_barrier_init(&sim_param->airport_end_sync, (workers+1));
+
+    for (int i = 0; i < workers; i++) {
+        pthread_create(
+                &sim_param->workers[i].thread,
+                NULL,
+                airport_worker,
+                &sim_param->workers[i]
+        );
+    }
+}
+
+/**
+ * @brief   Stops the pool of airport workers.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to simulation parameters data type.
+ *          -- Uses and alters the workers and the barriers.
+ */
+void stop_workers(simulation_param_t *sim_param)
+{
+    if (sim_param->worker_count == 1) {
+        return;
+    }
+
+    // The workers are released one last time so they can see the simulation
+    // is done.
+    sim_param->thread_done = true;
+    sim_barrier_wait(&sim_param->airport_start_sync);
+
+    for (int i = 0; i < sim_param->worker_count; i++) {
+        pthread_join(sim_param->workers[i].thread, NULL);
+    }
+
+    sim_barrier_destroy(&sim_param->airport_start_sync);
+    sim_barrier_destroy(&sim_param->airport_end_sync);
+}
+
+/**
+ * @brief   Airport worker thread function.
+ * @param   [in] arg: [void *]
+ *          -- The worker, which points back to its simulation.
+ * @return  [void *]
+ *          -- Will always return NULL.
+ * @details This function uses two barriers:
+ *          one prevents the workers from starting on a window before the
+ *          main thread has moved the clock to it,
+ *          and the other is to prevent the main thread from gathering the
+ *          window's results and moving the clock on before all workers are
+ *          done with it.
+ *          The done flag is only checked once past the first barrier, since
+ *          the main thread only knows the simulation is over after the
+ *          workers have gone through the last window.
+ */
+void* airport_worker(void *arg)
+{
+    worker_t *worker = arg;
+    simulation_param_t *sim_param = worker->sim_param;
+    worker_stats_t *stats = worker->stats;
+    uint64_t mark = (stats != NULL) ? stats_now() : 0;
+
+    while (true) {
+        sim_barrier_wait(&sim_param->airport_start_sync);
+
+        if (stats != NULL) {
+            stats_lap(&stats->wait_ns, &mark);
+        }
+
+        if (sim_param->thread_done) {
+            break;
+        }
+
+        run_worker_window(worker);
+
+        if (stats != NULL) {
+            stats_lap(&stats->busy_ns, &mark);
+        }
+
+        sim_barrier_wait(&sim_param->airport_end_sync);
+
+        if (stats != NULL) {
+            stats_lap(&stats->wait_ns, &mark);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief   Outputs the results of the flights that completed before the
+ *          current clock tick.
+ * @param   [in, out] sim_param: simulation_param_t*
+ *          -- Pointer to the simulation parameters.
+ *          -- Takes the flights output out of the list of flights completed.
+ * @details Results are ordered by completion time, carrier code, and flight
+ *          number. The clock only moves forward, so the results of the ticks
+ *          before it can be output as soon as every worker is through them,
+ *          only sorted among themselves. Workers that went further into the
+ *          last window have theirs held back until the clock catches up.
+ *          The fields are packed into a single key that is radix sorted, and
+ *          flights that tie on every field keep their flight order, which is
+ *          the order they completed in.
+ *          When streaming, the results are written out right away instead of
+ *          once the output's buffer fills up.
+ * @return  bool
+ *          -- True if the results were output, False if memory ran out.
+ */
+bool produce_simulation_results(simulation_param_t *sim_param)
+{
+    uint32_t count = sim_param->completed_count, output = 0;
+
+    if (count == 0) {
+        return true;
+    }
+
+    uint64_t *keys = malloc((size_t)count * sizeof(uint64_t));
+    uint32_t *order = malloc((size_t)count * sizeof(uint32_t));
+
+    if (keys == NULL || order == NULL) {
+        free(keys);
+        free(order);
+        fprintf(stderr, "atsim: out of memory\n");
+        sim_param->completed_count = 0;
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t index = sim_param->completed[i];
+
+        keys[i] = RESULT_KEY(&sim_param->flights[index],
+                             &sim_param->flight_info[index]);
+    }
+
+    bool sorted = sort_permutation(keys, order, count);
+
+    free(keys);
+
+    if (!sorted) {
+        free(order);
+        fprintf(stderr, "atsim: out of memory\n");
+        sim_param->completed_count = 0;
+        return false;
+    }
+
+    for (; output < count; output++) {
+        uint32_t index = sim_param->completed[order[output]];
+        flight_t *flight = &sim_param->flights[index];
+
+        if (flight->time.arrival >= sim_param->clock) {
+            break;
+        }
+
+        output_flight_log(&sim_param->output, flight,
+                          &sim_param->flight_info[index],
+                          AIRPORT(sim_param, flight->origin),
+                          AIRPORT(sim_param, flight->destination));
+    }
+
+    if (sim_param->stream) {
+        output_flush(&sim_param->output);
+    }
+
+    // The flights held back are kept, in the order of their results.
+    for (uint32_t i = output; i < count; i++) {
+        order[i - output] = sim_param->completed[order[i]];
+    }
+
+    memcpy(sim_param->completed, order, (count - output) * sizeof(uint32_t));
+    free(order);
+    sim_param->completed_count = count - output;
+    return true;
+}
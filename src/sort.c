@@ -0,0 +1,93 @@
+/**
+ * @file    sort.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function body of the radix sort used to
+ *          order the flights without moving the flights themselves.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sort.h"
+
+/**
+ * @brief   Sorts a set of keys, producing the order they should be read in.
+ * @param   [in] keys: const uint64_t*
+ *                     -- Key of each element, left untouched.
+ * @param   [out] order: uint32_t*
+ *                       -- Filled with the element indices, in key order.
+ * @param   [in] count: uint32_t
+ *                      -- Number of elements.
+ * @details LSD radix sort, so it is stable: elements with equal keys keep the
+ *          order they were given in. Byte positions where every key holds the
+ *          same value are skipped, which makes narrow keys cheap to sort.
+ * @return  bool
+ *          -- True if the keys were sorted, False if the scratch arrays
+ *             couldn't be allocated.
+ */
+bool sort_permutation(const uint64_t *keys, uint32_t *order, uint32_t count)
+{
+    uint32_t (*histogram)[SORT_RADIX_SIZE] = calloc(SORT_KEY_DIGITS,
+                                                    sizeof(*histogram));
+    uint64_t *key = malloc((size_t)count * sizeof(uint64_t));
+    uint64_t *key_scratch = malloc((size_t)count * sizeof(uint64_t));
+    uint32_t *order_buffer = malloc((size_t)count * sizeof(uint32_t));
+    uint32_t *index = order, *index_scratch = order_buffer;
+    bool sorted = (histogram != NULL && key != NULL &&
+                   key_scratch != NULL && order_buffer != NULL);
+
+    if (sorted) {
+        memcpy(key, keys, (size_t)count * sizeof(uint64_t));
+
+        for (uint32_t i = 0; i < count; i++) {
+            index[i] = i;
+
+            for (uint32_t d = 0; d < SORT_KEY_DIGITS; d++) {
+                histogram[d][(key[i] >> (d * SORT_RADIX_BITS)) &
+                             (SORT_RADIX_SIZE - 1)]++;
+            }
+        }
+
+        for (uint32_t d = 0; d < SORT_KEY_DIGITS && count > 0; d++) {
+            uint32_t shift = d * SORT_RADIX_BITS, offset = 0;
+
+            // Every key shares this byte, so the pass wouldn't move anything.
+            if (histogram[d][(key[0] >> shift) & (SORT_RADIX_SIZE - 1)] ==
+                count) {
+                continue;
+            }
+
+            for (uint32_t b = 0; b < SORT_RADIX_SIZE; b++) {
+                uint32_t bucket = histogram[d][b];
+                histogram[d][b] = offset;
+                offset += bucket;
+            }
+
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t slot = histogram[d][(key[i] >> shift) &
+                                             (SORT_RADIX_SIZE - 1)]++;
+                key_scratch[slot] = key[i];
+                index_scratch[slot] = index[i];
+            }
+
+            uint64_t *key_swap = key;
+            key = key_scratch;
+            key_scratch = key_swap;
+
+            uint32_t *index_swap = index;
+            index = index_scratch;
+            index_scratch = index_swap;
+        }
+
+        // An odd number of passes leaves the result in the scratch array.
+        if (index != order) {
+            memcpy(order, index, (size_t)count * sizeof(uint32_t));
+        }
+    }
+
+    free(histogram);
+    free(key);
+    free(key_scratch);
+    free(order_buffer);
+    return sorted;
+}
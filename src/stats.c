@@ -0,0 +1,100 @@
+/**
+ * @file    stats.c
+ * @author  Manuel Burnay
+ * @date    May 20, 2019
+ * @details This file contains the function bodies that write out the stats
+ *          of a simulation.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "stats.h"
+
+static const char *phase_names[STATS_PHASES] = {
+        "parse", "sort", "setup", "ticks", "results", "finish"
+};
+
+static const char *state_names[STATS_FLIGHT_STATES] = {
+        "stand_by", "departure_taxi", "wait_to_takeoff", "en_route",
+        "wait_to_land", "arrival_taxi", "complete"
+};
+
+/**
+ * @brief   Writes the stats of a simulation as JSON.
+ * @param   [in] stats: const stats_t*
+ *                      -- Pointer to the stats of a simulation that ran.
+ * @param   [in] path: const char*
+ *                     -- File the stats are written to, or NULL for
+ *                        standard error.
+ * @details Times are in seconds. Flights queue for a runway as they move
+ *          into the waiting states, and leave the queue as they move out of
+ *          them, so the queue operations are taken from the transitions.
+ * @return  bool
+ *          -- True if the stats were written, False if not.
+ */
+bool write_stats(const stats_t *stats, const char *path)
+{
+    FILE *file = (path != NULL) ? fopen(path, "w") : stderr;
+
+    if (file == NULL) {
+        fprintf(stderr, "atsim: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    fprintf(file, "{\n  \"total_s\": %.6f,\n  \"phases_s\": {",
+            stats->total_ns / 1e9);
+
+    for (int i = 0; i < STATS_PHASES; i++) {
+        fprintf(file, "%s\n    \"%s\": %.6f", (i > 0) ? "," : "",
+                phase_names[i], stats->phase_ns[i] / 1e9);
+    }
+
+    fprintf(file, "\n  },\n  \"flights\": %u,\n  \"ticks\": %llu,\n"
+                  "  \"transitions\": {",
+            stats->flights, (unsigned long long)stats->ticks);
+
+    // Nothing ever moves into standing by.
+    for (int i = DEPARTURE_TAXI; i < STATS_FLIGHT_STATES; i++) {
+        fprintf(file, "%s\n    \"%s\": %llu", (i > DEPARTURE_TAXI) ? "," : "",
+                state_names[i], (unsigned long long)stats->transitions[i]);
+    }
+
+    fprintf(file, "\n  },\n  \"events\": {\n    \"pushed\": %llu,\n"
+                  "    \"popped\": %llu\n  },\n"
+                  "  \"queues\": {\n    \"departures_enqueued\": %llu,\n"
+                  "    \"arrivals_enqueued\": %llu,\n"
+                  "    \"departures_dequeued\": %llu,\n"
+                  "    \"arrivals_dequeued\": %llu\n  },\n"
+                  "  \"results\": %llu,\n  \"workers\": [",
+            (unsigned long long)(stats->events_popped + stats->events_left),
+            (unsigned long long)stats->events_popped,
+            (unsigned long long)stats->transitions[WAIT_TO_TAKEOFF],
+            (unsigned long long)stats->transitions[WAIT_TO_LAND],
+            (unsigned long long)stats->transitions[EN_ROUTE],
+            (unsigned long long)stats->transitions[ARRIVAL_TAXI],
+            (unsigned long long)stats->results);
+
+    for (int i = 0; i < stats->workers; i++) {
+        const worker_stats_t *worker = &stats->worker[i];
+
+        fprintf(file, "%s\n    {\"wait_s\": %.6f, \"busy_s\": %.6f, "
+                      "\"airports\": %llu}",
+                (i > 0) ? "," : "", worker->wait_ns / 1e9,
+                worker->busy_ns / 1e9, (unsigned long long)worker->airports);
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+
+    bool written = !ferror(file);
+
+    if (path != NULL && fclose(file) != 0) {
+        written = false;
+    }
+
+    if (!written) {
+        fprintf(stderr, "atsim: the stats couldn't be written\n");
+    }
+
+    return written;
+}
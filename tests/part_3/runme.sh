@@ -0,0 +1,7 @@
+#!/bin/sh
+
+# The atsim built with "cmake -S . -B build && cmake --build build" from the
+# top of the repository, unless ATSIM names another one.
+ATSIM=${ATSIM:-../../build/bin/atsim}
+
+$ATSIM "$@"
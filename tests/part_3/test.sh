@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# Like the other parts, but each test can pass options to the program through
+# a $PREFIX.$T.args file, and the exit status tells whether every test passed.
+PREFIX=test
+TESTS='00 01 02 03 04 05 06 07 08 09 10'
+PROG=runme.sh
+count=0
+total=0
+DEBUG=0
+
+if [ "$1" = "debug" ]; then
+  DEBUG=1
+fi
+
+if [ ! -x $PROG ]; then
+  echo Error: $PROG is not in the current directory or is not executable
+  exit 1
+fi
+
+for T in $TESTS; do
+  total=$((total + 1))
+  if [ -f $PREFIX.$T.in ]; then
+    ARGS=
+    if [ -f $PREFIX.$T.args ]; then
+      ARGS=$(cat $PREFIX.$T.args)
+    fi
+    echo ===========================================
+    echo Test file: $PREFIX.$T.in $ARGS
+    ./$PROG $ARGS < $PREFIX.$T.in > $PREFIX.$T.out
+    if diff $PREFIX.$T.out $PREFIX.$T.gold > /dev/null; then
+      echo " " PASSED
+      count=$((count + 1))
+      rm $PREFIX.$T.out
+    elif [ $DEBUG -eq 1 ]; then
+        echo Test $T failed, here are the differences
+        echo My program output "                     " Expected program output
+        echo ================= "                     " =======================
+        diff -W 80 -y $PREFIX.$T.out $PREFIX.$T.gold | more
+        exit 1
+    else
+      echo " " FAILED
+    fi
+  else
+    echo Oops: file $PREFIX.$T.in does not exist!
+  fi
+done
+
+rm -f $PREFIX.ckpt
+
+echo =============================================
+echo $count tests passed
+[ $count -eq $total ]